@@ -6,6 +6,16 @@
 #define API
 #endif
 
+/**
+ * @brief Defined when building for the GTK backend.
+ *
+ * Some newer APIs are only implemented by the GTK backend so far. They are declared only when this is defined, so
+ * using one of them on another backend fails at compile time instead of at link time.
+ */
+#if defined(__linux__)
+#define uiBackendUnix 1
+#endif
+
 /**
  * @brief This constant is provided because M_PI is nonstandard.
  * @see http://oeis.org/A000796.
@@ -42,6 +52,48 @@ typedef int (uiQueueCancelableCallback) (void *data);
  */
 API void uiTimer (int milliseconds, uiQueueCancelableCallback *f, void *data);
 
+#ifdef uiBackendUnix
+/**
+ * @brief A timer that can be changed or canceled after it was started; see @p uiNewTimer.
+ */
+typedef struct uiTimerHandle uiTimerHandle;
+
+/**
+ * @brief Starts a timer running a function at a given interval on the UI thread, like @p uiTimer.
+ * @param milliseconds interval
+ * @param f pointer to the callback function; return non-zero to keep the timer running
+ * @param data to pass to the callback function
+ * @return @p uiTimerHandle, valid until @p f returns zero or the timer is canceled with @p uiTimerCancel
+ * @remark Timers are cheap: thousands of them, e.g. one per table row, cost no more main-loop work than the ones that
+ * are actually due.
+ */
+API uiTimerHandle *uiNewTimer (int milliseconds, uiQueueCancelableCallback *f, void *data);
+
+/**
+ * @brief Changes the interval of a timer and restarts its countdown.
+ * @param t @p uiTimerHandle
+ * @param milliseconds new interval
+ * @remark Can be called from the timer's own callback.
+ */
+API void uiTimerSetInterval (uiTimerHandle *t, int milliseconds);
+
+/**
+ * @brief Allows a timer to run late, so it can share a wakeup with other timers.
+ * @param t @p uiTimerHandle
+ * @param milliseconds how late the timer may run; 0, the default, for as close to on time as possible
+ * @remark Giving timers that don't need to be precise a tolerance lets the process sleep longer between wakeups.
+ * Takes effect the next time the timer is scheduled.
+ */
+API void uiTimerSetTolerance (uiTimerHandle *t, int milliseconds);
+
+/**
+ * @brief Stops a timer and frees @p t.
+ * @param t @p uiTimerHandle
+ * @remark Can be called from the timer's own callback; the callback's return value is then ignored.
+ */
+API void uiTimerCancel (uiTimerHandle *t);
+#endif
+
 /**
  * @brief Free the memory of a returned string.
  *
@@ -35,6 +35,38 @@ typedef struct uiAreaMouseEvent uiAreaMouseEvent;
  */
 typedef struct uiAreaKeyEvent uiAreaKeyEvent;
 
+#ifdef uiBackendUnix
+/**
+ * @brief One pointer position reported by the system; see @p uiAreaMotionHistory.
+ */
+typedef struct uiAreaMotionSample uiAreaMotionSample;
+
+/**
+ * @brief Timing of a display frame, passed to @p uiAreaOnFrame callbacks.
+ */
+typedef struct uiAreaFrameInfo uiAreaFrameInfo;
+
+/**
+ * @brief Frame-time statistics of a @p uiArea; see @p uiAreaFrameStatistics.
+ */
+typedef struct uiAreaFrameStats uiAreaFrameStats;
+
+/**
+ * @brief Drawing counters of a @p uiArea; see @p uiAreaDrawStatistics.
+ */
+typedef struct uiAreaDrawStats uiAreaDrawStats;
+
+/**
+ * @brief Whether a @p uiArea collects drawing counters; see @p uiAreaSetDrawStatistics.
+ */
+typedef enum uiAreaDrawStatsMode
+{
+  uiAreaDrawStatsOff,     //!< nothing is collected; the default
+  uiAreaDrawStatsCollect, //!< counters are collected for @p uiAreaDrawStatistics
+  uiAreaDrawStatsLog,     //!< counters are collected and also logged after every draw pass
+} uiAreaDrawStatsMode;
+#endif
+
 /**
  * Keyboard modifier keys.
  *
@@ -118,6 +150,45 @@ struct uiAreaMouseEvent
   uint64_t    Held1To64;  //!<
 };
 
+#ifdef uiBackendUnix
+struct uiAreaMotionSample
+{
+  double   X;    //!< position
+  double   Y;    //!< position
+  uint64_t Time; //!< system event timestamp, in milliseconds
+};
+
+struct uiAreaFrameInfo
+{
+  int64_t  FrameTime;        //!< time of the frame being prepared, in monotonic microseconds
+  int64_t  PresentationTime; //!< predicted time the frame reaches the screen, in monotonic microseconds; 0 if unknown
+  int64_t  RefreshInterval;  //!< display refresh interval in microseconds; 0 if unknown
+  uint64_t FrameCounter;     //!< increases by one for every frame of the window
+};
+
+struct uiAreaFrameStats
+{
+  uint64_t Frames;          //!< number of frames delivered since the callback was installed
+  int64_t  AverageInterval; //!< average time between consecutive frames, in microseconds
+  int64_t  MaxInterval;     //!< longest time between consecutive frames, in microseconds
+  uint64_t LateFrames;      //!< frames that arrived more than half a refresh interval late
+};
+
+struct uiAreaDrawStats
+{
+  uint64_t Passes;       //!< draw passes counted
+  uint64_t Fills;        //!< fill operations, including one per color run of the batched fill functions
+  uint64_t Strokes;      //!< stroke operations, including one per color run of the batched stroke functions
+  uint64_t Clips;        //!< @p uiDrawClip calls
+  uint64_t PathSegments; //!< path segments handed to the rasterizer by fills, strokes and clips
+  uint64_t TextLayouts;  //!< text layouts drawn
+  uint64_t Patterns;     //!< gradient patterns that had to be created because they were not cached
+  uint64_t HandlerTime;  //!< time spent in the @p Draw handler, in nanoseconds
+  uint64_t DrawingTime;  //!< part of @p HandlerTime spent inside libui drawing functions, in nanoseconds
+  double   ClipArea;     //!< area that was redrawn, in square pixels
+};
+#endif
+
 struct uiAreaDrawParams
 {
   /**
@@ -212,6 +283,105 @@ API void uiAreaSetSize (uiArea *a, int width, int height);
  */
 API void uiAreaQueueRedrawAll (const uiArea *a);
 
+#ifdef uiBackendUnix
+/**
+ * @brief Queues a redraw of part of @p a.
+ * @param a @p uiArea
+ * @param x horizontal position of the area to redraw
+ * @param y vertical position of the area to redraw
+ * @param width width of the area to redraw
+ * @param height height of the area to redraw
+ * @remark If the area has a tile cache, the tiles covering the rectangle are discarded and rendered again.
+ */
+API void uiAreaInvalidateRect (uiArea *a, double x, double y, double width, double height);
+
+/**
+ * @brief Enables caching of rendered content for a scrolling area.
+ * @param a scrolling @p uiArea
+ * @param tileSize edge length of a square tile in drawing space units, or 0 to disable the cache
+ * @param budget maximum number of bytes the cached tiles may use
+ * @remark The Draw handler is called once per tile, with the clip rectangle set to that tile. Scrolling back and forth
+ * then mostly composites tiles that were already rendered. Tiles are evicted least recently used first, but the
+ * tiles on screen are always kept.
+ * @remark Call @p uiAreaInvalidateRect when part of the content changes; @p uiAreaQueueRedrawAll and
+ * @p uiAreaSetSize discard the whole cache.
+ * @note Only scrolling areas can use a tile cache.
+ */
+API void uiAreaSetTileCache (uiArea *a, int tileSize, size_t budget);
+
+/**
+ * @brief Sets whether the tiles of a scrolling area are rendered on worker threads.
+ * @param a scrolling @p uiArea
+ * @param async non-zero to render tiles on worker threads, 0 to render them on the main thread (the default)
+ * @remark When enabled, the Draw handler is called on a pool of worker threads, several tiles at a time, and the main
+ * thread only composites finished tiles. Until a tile arrives, the previous contents of that tile are shown, or
+ * nothing if it was never rendered. The setting takes effect whenever a tile cache is set with
+ * @p uiAreaSetTileCache.
+ * @warning The Draw handler must then be thread-safe: it may only use the @p uiDraw functions on the context it is
+ * given and must not access controls. Any data it reads must be protected against concurrent changes from the main
+ * thread; call @p uiAreaInvalidateRect after changing it.
+ */
+API void uiAreaSetAsyncTileRendering (uiArea *a, int async);
+
+/**
+ * @brief Sets whether pointer motion is delivered at most once per display frame.
+ * @param a @p uiArea
+ * @param coalesce non-zero to coalesce motion, 0 to deliver every motion event (the default)
+ * @remark When enabled, motion events received between two frames are merged into one @p MouseEvent with the latest
+ * position, delivered just before the frame is drawn. Button and crossing events first deliver any pending motion, so
+ * their order is kept. Use @p uiAreaMotionHistory to get every intermediate position.
+ */
+API void uiAreaSetMotionCoalescing (uiArea *a, int coalesce);
+
+/**
+ * @brief Gets the pointer positions merged into the motion event being handled.
+ * @param a @p uiArea
+ * @param[out] samples array receiving up to @p n samples, oldest first; the last one is the position of the event
+ * @param n size of @p samples
+ * @return the number of samples available, which may be more than @p n
+ * @remark Only valid from within a @p MouseEvent handler. Without coalescing, and for motion events that merged
+ * nothing, there is one sample; for button events there are none.
+ */
+API size_t uiAreaMotionHistory (uiArea *a, uiAreaMotionSample *samples, size_t n);
+
+/**
+ * @brief Registers a callback to run once per display frame of @p a, synchronized to the display's refresh.
+ * @param a @p uiArea
+ * @param f callback; return non-zero to keep receiving frames, or zero to stop. @p NULL stops the current callback.
+ * @param data user data passed to @p f
+ * @remark Frames are only delivered while @p a is on screen; the callback pauses while it is hidden or its window is
+ * minimized, and resumes afterward. Call @p uiAreaQueueRedrawAll from @p f to draw the new state in the same frame.
+ * @remark Installing a different callback resets the statistics returned by @p uiAreaFrameStatistics.
+ */
+API void uiAreaOnFrame (uiArea *a, int (*f) (uiArea *a, const uiAreaFrameInfo *info, void *data), void *data);
+
+/**
+ * @brief Gets frame-time statistics for the callback registered with @p uiAreaOnFrame.
+ * @param a @p uiArea
+ * @param[out] stats @p uiAreaFrameStats
+ */
+API void uiAreaFrameStatistics (uiArea *a, uiAreaFrameStats *stats);
+
+/**
+ * @brief Turns the drawing counters of @p a on or off.
+ * @param a @p uiArea
+ * @param mode @p uiAreaDrawStatsMode
+ * @remark Counting costs a little time in every drawing function, so it is off by default. Turning it on resets the
+ * counters. Drawing done by worker threads for @p uiAreaSetAsyncTileRendering is not counted.
+ */
+API void uiAreaSetDrawStatistics (uiArea *a, uiAreaDrawStatsMode mode);
+
+/**
+ * @brief Gets the drawing counters of @p a.
+ * @param a @p uiArea
+ * @param[out] last counters of the most recent draw pass; may be @p NULL
+ * @param[out] total sums of the counters of all passes since they were turned on; may be @p NULL
+ * @remark Comparing @p HandlerTime with @p DrawingTime tells time spent rasterizing apart from time spent in the
+ * application's own code.
+ */
+API void uiAreaDrawStatistics (uiArea *a, uiAreaDrawStats *last, uiAreaDrawStats *total);
+#endif
+
 /**
  * @brief Scrolls a @p uiArea to the given bounds
  * @param a @p uiArea
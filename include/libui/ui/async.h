@@ -0,0 +1,56 @@
+#pragma once
+
+#include "api.h"
+
+#ifdef uiBackendUnix
+/**
+ * @brief A function running on a worker thread of the pool behind @p uiRunAsync.
+ *
+ * Tasks are the unit of work of that pool. Each one runs a work function on some worker thread and then a completion
+ * function on the UI thread, so long computations such as building a model or parsing a file don't block @p uiMain.
+ *
+ * The pool steals work: tasks started from a worker stay with that worker unless another one runs out of work, so work
+ * that splits itself into more tasks spreads over the threads without a central queue.
+ *
+ * @p uiAsyncTask also serves as the task's cancellation token; see @p uiAsyncCancel.
+ */
+typedef struct uiAsyncTask uiAsyncTask;
+
+/**
+ * @brief Runs @p work on a worker thread, and then @p done on the UI thread.
+ * @param work function run on a worker thread; may be skipped if the task was canceled before it started
+ * @param done function run on the UI thread after @p work returned or was skipped; may be @p NULL. @p canceled is
+ * non-zero if @p uiAsyncCancel was called for the task.
+ * @param data passed to @p work and @p done
+ * @return @p uiAsyncTask, valid until @p done returns
+ * @remark Can be called from the UI thread and from worker threads, e.g. to split work into smaller tasks.
+ * @remark Calls of @p done are delivered like @p uiQueueMain, so many tasks finishing together cost one main-loop
+ * wakeup.
+ */
+API uiAsyncTask *uiRunAsync (void (*work) (uiAsyncTask *task, void *data),
+                             void (*done) (uiAsyncTask *task, int canceled, void *data), void *data);
+
+/**
+ * @brief Asks a task to stop.
+ * @param task @p uiAsyncTask
+ * @remark A task that has not started is not run; a running one keeps running until its work function notices
+ * @p uiAsyncCanceled. Either way its @p done function is still called, with @p canceled set.
+ */
+API void uiAsyncCancel (uiAsyncTask *task);
+
+/**
+ * @brief Tells a work function whether it should stop.
+ * @param task @p uiAsyncTask
+ * @return non-zero if @p uiAsyncCancel was called for @p task
+ * @remark Work functions should check this regularly; it is cheap to call.
+ */
+API int uiAsyncCanceled (uiAsyncTask *task);
+
+/**
+ * @brief Sets the number of worker threads of the pool behind @p uiRunAsync.
+ * @param n number of workers; 0, the default, for one per processor
+ * @remark Workers are started when the first task is run. Lowering the number after that lets the extra workers exit
+ * once they have nothing left to do.
+ */
+API void uiAsyncSetWorkers (int n);
+#endif
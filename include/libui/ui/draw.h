@@ -4,6 +4,9 @@
 #include "attributed_string.h"
 #include "font_descriptor.h"
 
+#include <stddef.h>
+#include <stdint.h>
+
 /**
  * @brief The default for both Cairo and Direct2D (in the latter case, from the C++ helper functions).
  *
@@ -57,6 +60,23 @@ typedef struct uiDrawTextLayout uiDrawTextLayout;
  */
 typedef struct uiDrawTextLayoutParams uiDrawTextLayoutParams;
 
+#ifdef uiBackendUnix
+/**
+ * @brief Counters of the text layout cache; see @p uiDrawTextLayoutCacheStatistics.
+ */
+typedef struct uiDrawTextLayoutCacheStats uiDrawTextLayoutCacheStats;
+
+/**
+ * @brief Position and size of one line of a @p uiDrawTextLayout; see @p uiDrawTextLayoutLineGetMetrics.
+ */
+typedef struct uiDrawTextLayoutLineMetrics uiDrawTextLayoutLineMetrics;
+
+/**
+ * @brief A caller-owned pixel buffer that can be drawn into a @p uiDrawContext without copying.
+ */
+typedef struct uiDrawBitmap uiDrawBitmap;
+#endif
+
 /**
  * @brief Brush types.
  */
@@ -107,6 +127,17 @@ typedef enum uiDrawTextAlign
   uiDrawTextAlignRight,  //!< right-align
 } uiDrawTextAlign;
 
+#ifdef uiBackendUnix
+/**
+ * @brief Sampling filters used when a @p uiDrawBitmap is scaled or transformed.
+ */
+typedef enum uiDrawBitmapFilter
+{
+  uiDrawBitmapFilterNearest,  //!< nearest-neighbor; keeps hard pixel edges
+  uiDrawBitmapFilterBilinear, //!< bilinear interpolation
+} uiDrawBitmapFilter;
+#endif
+
 struct uiDrawMatrix
 {
   double M11; //!<
@@ -165,6 +196,29 @@ struct uiDrawTextLayoutParams
   uiDrawTextAlign     Align;       //!< text-alignment
 };
 
+#ifdef uiBackendUnix
+struct uiDrawTextLayoutCacheStats
+{
+  uint64_t Hits;      //!< layouts that were already in the cache
+  uint64_t Misses;    //!< layouts that had to be made
+  uint64_t Evictions; //!< layouts dropped to keep the cache within its size
+  size_t   Entries;   //!< layouts currently in the cache
+};
+
+struct uiDrawTextLayoutLineMetrics
+{
+  double X;         //!< left edge of the line, relative to the top-left of the layout
+  double Y;         //!< top edge of the line, relative to the top-left of the layout
+  double Width;     //!< width of the line
+  double Height;    //!< height of the line, including line spacing
+  double BaselineY; //!< position of the baseline, relative to the top of the layout
+  double Ascent;    //!< distance from the top of the line to the baseline
+  double Descent;   //!< distance from the baseline to the bottom of the line
+  size_t Start;     //!< byte index of the first character of the line
+  size_t End;       //!< byte index just past the last character of the line, including any line break
+};
+#endif
+
 /**
  * @brief @p uiDrawPath constructor
  * @param fillMode
@@ -261,6 +315,57 @@ API int uiDrawPathEnded (uiDrawPath *p);
  */
 API void uiDrawPathEnd (uiDrawPath *p);
 
+#ifdef uiBackendUnix
+/**
+ * @brief Gets the bounding box of what filling or stroking a path covers.
+ * @param p ended @p uiDrawPath
+ * @param stroke @p NULL for the filled path, or the parameters of the stroke
+ * @param[out] x horizontal position
+ * @param[out] y vertical position
+ * @param[out] width width
+ * @param[out] height height
+ * @remark The result is computed once per path and stroke parameters and cached, so testing whether a path is
+ * visible before drawing it is cheap.
+ * @remark Can be called on any thread, e.g. from a Draw handler running on a worker thread; see
+ * @p uiAreaSetAsyncTileRendering. Because results are cached in @p p, a path must not be queried on two threads at
+ * once.
+ */
+API void uiDrawPathBounds (uiDrawPath *p, const uiDrawStrokeParams *stroke, double *x, double *y, double *width,
+                           double *height);
+
+/**
+ * @brief Tests whether filling or stroking a path covers a point.
+ * @param p ended @p uiDrawPath
+ * @param stroke @p NULL to test the filled path, honoring its fill mode, or the parameters of the stroke to test
+ * @param x horizontal position
+ * @param y vertical position
+ * @return non-zero if the point is covered
+ * @remark The thread rules of @p uiDrawPathBounds apply.
+ */
+API int uiDrawPathContainsPoint (uiDrawPath *p, const uiDrawStrokeParams *stroke, double x, double y);
+
+/**
+ * @brief Gets the length of all figures of a path.
+ * @param p ended @p uiDrawPath
+ * @return the length, including the closing segments of closed figures
+ * @remark The thread rules of @p uiDrawPathBounds apply.
+ */
+API double uiDrawPathLength (uiDrawPath *p);
+
+/**
+ * @brief Approximates a path with straight line segments.
+ * @param p ended @p uiDrawPath
+ * @param[out] points array receiving up to @p n points, each as @code [x, y]@endcode
+ * @param[out] newFigure array receiving up to @p n flags; non-zero where a point starts a new figure. May be @p NULL.
+ * @param n number of points @p points and @p newFigure can hold
+ * @return the number of points of the flattened path, which may be more than @p n
+ * @remark Curves and arcs are split finely enough that no segment strays more than 0.1 units from the curve. Closed
+ * figures end with a copy of their first point. The flattened path is computed once and cached.
+ * @remark The thread rules of @p uiDrawPathBounds apply.
+ */
+API size_t uiDrawPathFlatten (uiDrawPath *p, double *points, int *newFigure, size_t n);
+#endif
+
 /**
  * @brief Draws a brush stroke
  * @param c @p uiDrawContext
@@ -278,6 +383,57 @@ API void uiDrawStroke (uiDrawContext *c, uiDrawPath *path, uiDrawBrush *b, uiDra
  */
 API void uiDrawFill (uiDrawContext *c, uiDrawPath *path, uiDrawBrush *b);
 
+#ifdef uiBackendUnix
+/**
+ * @brief Fills many axis-aligned rectangles in one call.
+ * @param c @p uiDrawContext
+ * @param rects packed array of @p n rectangles, each as @code [x, y, width, height]@endcode
+ * @param n number of rectangles
+ * @param b @p uiDrawBrush used for every rectangle; ignored when @p colors is not @p NULL
+ * @param colors optional packed array of @p n colors, each as @code [R, G, B, A]@endcode
+ * @remark Consecutive rectangles with the same color are filled as one shape, so overlapping rectangles of the same
+ * translucent color are composited once rather than once per rectangle.
+ */
+API void uiDrawFillRectangles (uiDrawContext *c, const double *rects, size_t n, uiDrawBrush *b, const double *colors);
+
+/**
+ * @brief Fills many circles of the same radius in one call, e.g. scatter plot markers.
+ * @param c @p uiDrawContext
+ * @param centers packed array of @p n center points, each as @code [x, y]@endcode
+ * @param n number of circles
+ * @param radius of every circle
+ * @param b @p uiDrawBrush used for every circle; ignored when @p colors is not @p NULL
+ * @param colors optional packed array of @p n colors, each as @code [R, G, B, A]@endcode
+ * @remark Overlapping circles of the same color are composited once; see @p uiDrawFillRectangles.
+ */
+API void uiDrawFillCircles (uiDrawContext *c, const double *centers, size_t n, double radius, uiDrawBrush *b,
+                            const double *colors);
+
+/**
+ * @brief Strokes many independent line segments in one call.
+ * @param c @p uiDrawContext
+ * @param lines packed array of @p n segments, each as @code [x0, y0, x1, y1]@endcode
+ * @param n number of segments
+ * @param b @p uiDrawBrush used for every segment; ignored when @p colors is not @p NULL
+ * @param p @p uiDrawStrokeParams shared by every segment
+ * @param colors optional packed array of @p n colors, each as @code [R, G, B, A]@endcode
+ * @remark Overlapping segments of the same color are composited once; see @p uiDrawFillRectangles.
+ */
+API void uiDrawStrokeLines (uiDrawContext *c, const double *lines, size_t n, uiDrawBrush *b, uiDrawStrokeParams *p,
+                            const double *colors);
+
+/**
+ * @brief Strokes a single open polyline through @p n points.
+ * @param c @p uiDrawContext
+ * @param points packed array of @p n points, each as @code [x, y]@endcode
+ * @param n number of points
+ * @param b @p uiDrawBrush
+ * @param p @p uiDrawStrokeParams
+ */
+API void uiDrawStrokePolyline (uiDrawContext *c, const double *points, size_t n, uiDrawBrush *b,
+                               uiDrawStrokeParams *p);
+#endif
+
 /**
  * @brief Sets the identity of a @p uiDrawMatrix
  * @param m @p uiDrawMatrix
@@ -382,10 +538,80 @@ API void uiDrawSave (uiDrawContext *c);
  */
 API void uiDrawRestore (uiDrawContext *c);
 
+#ifdef uiBackendUnix
+/**
+ * @brief @p uiDrawBitmap constructor
+ * @param pixels premultiplied 32-bit ARGB pixels in native byte order, i.e. @code 0xAARRGGBB@endcode when read as a
+ * @p uint32_t
+ * @param width in pixels
+ * @param height in pixels
+ * @param byteStride number of bytes per row of @p pixels; must be a multiple of 4 and at least @code width * 4@endcode
+ * @return @p uiDrawBitmap
+ * @remark @p pixels is not copied. It must stay valid until @p uiDrawFreeBitmap is called, and may be written to
+ * between draws, but never while a draw handler that draws @p bmp is running; call @p uiDrawBitmapMarkDirty
+ * afterwards.
+ */
+API uiDrawBitmap *uiDrawNewBitmap (void *pixels, int width, int height, int byteStride);
+
+/**
+ * @brief @p uiDrawBitmap destructor
+ * @param bmp @p uiDrawBitmap
+ * @remark The pixel buffer is not freed.
+ */
+API void uiDrawFreeBitmap (uiDrawBitmap *bmp);
+
+/**
+ * @brief Tells LibUI that part of the pixel buffer of @p bmp was modified by the caller.
+ * @param bmp @p uiDrawBitmap
+ * @param x left edge of the modified region, in pixels
+ * @param y top edge of the modified region, in pixels
+ * @param width of the modified region, in pixels
+ * @param height of the modified region, in pixels
+ * @remark Call this after every write to the pixel buffer and before the next draw of @p bmp, or the draw may show
+ * the old pixels. The region must lie within @p bmp.
+ * @remark Only the given region is re-uploaded by backends that cache bitmaps, so updating a small region of a large
+ * bitmap every frame stays cheap.
+ */
+API void uiDrawBitmapMarkDirty (uiDrawBitmap *bmp, int x, int y, int width, int height);
+
+/**
+ * @brief Converts 8-bit RGBA pixels into a region of the pixel buffer of @p bmp and marks that region dirty.
+ * @param bmp @p uiDrawBitmap
+ * @param x left edge of the destination region, in pixels
+ * @param y top edge of the destination region, in pixels
+ * @param pixels byte array of pixels in [R G B A] order
+ * @param width of @p pixels, in pixels
+ * @param height of @p pixels, in pixels
+ * @param byteStride number of bytes per row of @p pixels
+ * @param premultiplied non-zero when @p pixels already has premultiplied alpha; zero for straight alpha
+ * @remark The conversion is vectorized where the CPU supports it; this is the fast path for feeding decoded images or
+ * camera frames into a @p uiDrawBitmap.
+ */
+API void uiDrawBitmapCopyRGBA (uiDrawBitmap *bmp, int x, int y, const void *pixels, int width, int height,
+                               int byteStride, int premultiplied);
+
+/**
+ * @brief Draws @p bmp scaled into the rectangle at @code (x, y)@endcode with the given size.
+ * @param c @p uiDrawContext
+ * @param bmp @p uiDrawBitmap
+ * @param x position
+ * @param y position
+ * @param width size
+ * @param height size
+ * @param filter @p uiDrawBitmapFilter
+ * @remark The current transform of @p c applies; use @p uiDrawTransform for rotation or skew.
+ */
+API void uiDrawBlit (uiDrawContext *c, uiDrawBitmap *bmp, double x, double y, double width, double height,
+                     uiDrawBitmapFilter filter);
+#endif
+
 /**
  * @brief @p uiDrawTextLayout constructor
  * @param params @p uiDrawTextLayoutParams
  * @return @p uiDrawTextLayout
+ * @remark Layouts are cached: asking again for the same string contents, default font, width and alignment shares the
+ * layout made the first time instead of laying the text out again, so layouts can be made afresh in every draw
+ * handler. Changing the string makes a new layout on the next call.
  */
 API uiDrawTextLayout *uiDrawNewTextLayout (uiDrawTextLayoutParams *params);
 
@@ -402,9 +628,26 @@ API void uiDrawFreeTextLayout (uiDrawTextLayout *tl);
  * @param tl @p uiDrawTextLayout
  * @param x position
  * @param y position
+ * @remark Text without a color attribute is drawn in black. On the GTK backend, @p uiDrawTextWithBrush can choose
+ * another default.
  */
 API void uiDrawText (uiDrawContext *c, uiDrawTextLayout *tl, double x, double y);
 
+#ifdef uiBackendUnix
+/**
+ * @brief Draws @p tl in @p c with the top-left point of @p tl at @code (x, y)@endcode, painting text without a color
+ * attribute with @p b.
+ * @param c @p uiDrawContext
+ * @param tl @p uiDrawTextLayout
+ * @param x position
+ * @param y position
+ * @param b @p uiDrawBrush; gradients are positioned in the coordinates of @p c, not relative to the text
+ * @remark Only the lines whose glyphs reach into the clip of @p c are drawn, so drawing a long document in an area that
+ * shows a few lines of it is cheap.
+ */
+API void uiDrawTextWithBrush (uiDrawContext *c, uiDrawTextLayout *tl, double x, double y, uiDrawBrush *b);
+#endif
+
 /**
  * @brief Gets the width and height of @p tl in @p width and @p height.
  * @param tl @p uiDrawTextLayout
@@ -414,3 +657,63 @@ API void uiDrawText (uiDrawContext *c, uiDrawTextLayout *tl, double x, double y)
  * text in @p tl is wrapped. Therefore, you can use this function to get the actual size of the text layout.
  */
 API void uiDrawTextLayoutExtents (uiDrawTextLayout *tl, double *width, double *height);
+
+#ifdef uiBackendUnix
+/**
+ * @brief Gets the number of lines of @p tl.
+ * @param tl @p uiDrawTextLayout
+ * @return number of lines; at least 1, even for an empty string
+ */
+API int uiDrawTextLayoutNumLines (uiDrawTextLayout *tl);
+
+/**
+ * @brief Gets the position and size of a line of @p tl.
+ * @param tl @p uiDrawTextLayout
+ * @param line line number, from 0 to @p uiDrawTextLayoutNumLines() - 1
+ * @param[out] m @p uiDrawTextLayoutLineMetrics
+ */
+API void uiDrawTextLayoutLineGetMetrics (uiDrawTextLayout *tl, int line, uiDrawTextLayoutLineMetrics *m);
+
+/**
+ * @brief Finds the character position closest to a point, e.g. to place the caret where the user clicked.
+ * @param tl @p uiDrawTextLayout
+ * @param x horizontal position, relative to the top-left of @p tl
+ * @param y vertical position, relative to the top-left of @p tl
+ * @param[out] pos byte index into the string of the caret position closest to the point; the index after a
+ * character when the point is on its trailing half
+ * @param[out] line line of @p pos; may be @p NULL
+ * @return non-zero if the point is on the text, 0 if it is outside and @p pos is only the closest position
+ */
+API int uiDrawTextLayoutHitTest (uiDrawTextLayout *tl, double x, double y, size_t *pos, int *line);
+
+/**
+ * @brief Gets the caret rectangle of a character position.
+ * @param tl @p uiDrawTextLayout
+ * @param pos byte index into the string
+ * @param[out] x horizontal position of the caret, relative to the top-left of @p tl
+ * @param[out] y top of the caret, relative to the top-left of @p tl
+ * @param[out] height height of the caret; draw it with whatever width looks right
+ * @param[out] line line of @p pos; may be @p NULL
+ */
+API void uiDrawTextLayoutCaret (uiDrawTextLayout *tl, size_t pos, double *x, double *y, double *height, int *line);
+
+/**
+ * @brief Gets the rectangles covering a range of characters, e.g. to draw a selection.
+ * @param tl @p uiDrawTextLayout
+ * @param start byte index of the first character
+ * @param end byte index just past the last character
+ * @param[out] rects array receiving up to @p n rectangles as @code x, y, width, height@endcode quadruples
+ * @param n number of rectangles @p rects has room for
+ * @return the number of rectangles of the range, which may be more than @p n
+ * @remark A range spanning lines gets at least one rectangle per line, and bidirectional text can need several for
+ * a single line. Pass 0 for @p n to count the rectangles first.
+ */
+API size_t uiDrawTextLayoutRangeRects (uiDrawTextLayout *tl, size_t start, size_t end, double *rects, size_t n);
+
+/**
+ * @brief Gets the counters of the cache used by @p uiDrawNewTextLayout.
+ * @param[out] stats @p uiDrawTextLayoutCacheStats
+ * @remark The counters cover the layouts made on the main thread since @p uiInit.
+ */
+API void uiDrawTextLayoutCacheStatistics (uiDrawTextLayoutCacheStats *stats);
+#endif
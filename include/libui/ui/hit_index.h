@@ -0,0 +1,86 @@
+#pragma once
+
+#include "api.h"
+#include "draw.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief A spatial index of shapes for hit-testing, e.g. to find the shape under the mouse in a @p uiArea.
+ *
+ * Shapes are added with a user-chosen id, either as plain rectangles or, on the GTK backend, as @p uiDrawPath objects.
+ * Queries first narrow the candidates down with an R-tree over the shapes' bounding boxes and then test paths exactly,
+ * so a hover test takes logarithmic time in the number of shapes.
+ *
+ * The tree is rebuilt on the first query after shapes were added; adding all shapes of a scene and then querying many
+ * times is the intended use.
+ */
+typedef struct uiHitIndex uiHitIndex;
+
+/**
+ * @brief @p uiHitIndex constructor
+ * @return @p uiHitIndex
+ */
+API uiHitIndex *uiNewHitIndex (void);
+
+/**
+ * @brief @p uiHitIndex destructor
+ * @param idx @p uiHitIndex
+ */
+API void uiFreeHitIndex (uiHitIndex *idx);
+
+/**
+ * @brief Adds a rectangle.
+ * @param idx @p uiHitIndex
+ * @param id returned by queries that hit the rectangle
+ * @param x horizontal position
+ * @param y vertical position
+ * @param width width
+ * @param height height
+ * @remark A negative @p width or @p height extends the rectangle to the left or up.
+ */
+API void uiHitIndexAddRectangle (uiHitIndex *idx, uintptr_t id, double x, double y, double width, double height);
+
+#ifdef uiBackendUnix
+/**
+ * @brief Adds a path.
+ * @param idx @p uiHitIndex
+ * @param id returned by queries that hit the path
+ * @param path ended @p uiDrawPath
+ * @param stroke @p NULL to hit-test the filled path, or the parameters of the stroke to hit-test
+ * @remark The path is not copied and must stay alive until @p idx is cleared or freed. @p stroke is copied.
+ */
+API void uiHitIndexAddPath (uiHitIndex *idx, uintptr_t id, uiDrawPath *path, const uiDrawStrokeParams *stroke);
+#endif
+
+/**
+ * @brief Removes all shapes.
+ * @param idx @p uiHitIndex
+ */
+API void uiHitIndexClear (uiHitIndex *idx);
+
+/**
+ * @brief Finds the topmost shape containing a point.
+ * @param idx @p uiHitIndex
+ * @param x horizontal position
+ * @param y vertical position
+ * @param[out] id id of the shape that was added last among those containing the point
+ * @return non-zero if a shape contains the point, 0 otherwise
+ */
+API int uiHitIndexHitTest (uiHitIndex *idx, double x, double y, uintptr_t *id);
+
+/**
+ * @brief Finds the shapes whose bounding boxes intersect a rectangle.
+ * @param idx @p uiHitIndex
+ * @param x horizontal position
+ * @param y vertical position
+ * @param width width
+ * @param height height
+ * @param[out] ids array receiving up to @p n ids, in no particular order
+ * @param n size of @p ids
+ * @return the number of shapes found, which may be more than @p n
+ * @remark As with @p uiHitIndexAddRectangle, a negative @p width or @p height extends the rectangle to the left or up.
+ */
+API size_t uiHitIndexQueryRectangle (uiHitIndex *idx, double x, double y, double width, double height, uintptr_t *ids,
+                                     size_t n);
@@ -29,3 +29,24 @@ API void uiUninit (void);
  * @param err string
  */
 API void uiFreeInitError (const char *err);
+
+#ifdef uiBackendUnix
+/**
+ * @brief How long @p uiInit took, by phase.
+ */
+typedef struct uiInitTimings
+{
+  uint64_t Toolkit;  //!< initializing the native toolkit, e.g. connecting to the display, in nanoseconds
+  uint64_t Libui;    //!< libui's own initialization, in nanoseconds
+  uint64_t Total;    //!< all of @p uiInit, in nanoseconds
+  uint64_t Deferred; //!< time spent since then making subsystems on their first use, in nanoseconds
+} uiInitTimings;
+
+/**
+ * @brief Gets how long the last @p uiInit took.
+ * @param[out] t @p uiInitTimings
+ * @remark libui makes subsystems that many programs never use, such as timers and the @p uiRunAsync pool, when they
+ * are first used rather than in @p uiInit; their cost shows up in @p t->Deferred instead.
+ */
+API void uiInitStatistics (uiInitTimings *t);
+#endif
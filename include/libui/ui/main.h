@@ -2,6 +2,8 @@
 
 #include "api.h"
 
+#include <stdint.h>
+
 /**
  * @brief LibUI's main entry-point.
  * @remark this is a thread-blocking call
@@ -23,6 +25,114 @@ API void uiMainSteps (void);
  */
 API int uiMainStep (int wait);
 
+#ifdef uiBackendUnix
+/**
+ * @brief What a call of @p uiMainStepFor did.
+ */
+typedef struct uiMainStepResult
+{
+  int     Iterations; //!< main loop iterations that dispatched something
+  int     Pending;    //!< non-zero if events were still waiting when the deadline passed
+  int64_t Elapsed;    //!< time spent, in nanoseconds
+  int64_t NextWakeup; //!< @p uiMainTime at which something is due next, e.g. a timer; -1 if nothing is scheduled
+} uiMainStepResult;
+
+/**
+ * @brief Returns the clock @p uiMainStepFor works with.
+ * @return monotonic time in nanoseconds, from an unspecified starting point
+ */
+API int64_t uiMainTime (void);
+
+/**
+ * @brief Dispatches events until there are none left or until a deadline, for hosts running their own frame loop.
+ * @param deadline @p uiMainTime after which no more events are dispatched
+ * @param[out] result what was done, or @p NULL
+ * @return 0 if @p uiQuit was called, non-zero otherwise, like @p uiMainStep
+ * @remark Never waits. At least one iteration runs, even if the deadline has passed already, so the user interface
+ * can't starve.
+ * @remark @p result->NextWakeup lets the host sleep until libui next has something to do, instead of polling; input
+ * may still arrive earlier.
+ * @see uiMainSteps
+ */
+API int uiMainStepFor (int64_t deadline, uiMainStepResult *result);
+
+/**
+ * @brief What the main loop spends its time on; see @p uiMainSourceStatistics.
+ */
+typedef enum uiMainSource
+{
+  uiMainSourceQueue,   //!< calls queued with @p uiQueueMain and @p uiQueueMainCoalesced, including @p uiRunAsync
+  uiMainSourceTimer,   //!< timer callbacks
+  uiMainSourceFDWatch, //!< @p uiMainWatchFD callbacks
+  uiMainSourceInput,   //!< input and window events, with the handlers and control signals they run
+  uiMainSourceIdle,    //!< @p uiQueueIdle callbacks
+  uiMainSourceOther,   //!< everything else, e.g. layout and painting
+  uiMainSourceCount,   //!< number of sources; not a source
+} uiMainSource;
+
+/**
+ * @brief Main loop counters of one @p uiMainSource.
+ */
+typedef struct uiMainSourceStats
+{
+  uint64_t Dispatches; //!< callbacks or events run
+  uint64_t Time;       //!< time spent running them, in nanoseconds
+  uint64_t MaxTime;    //!< longest one, in nanoseconds
+  uint64_t Latency;    //!< queue and timers only: total time from queued or due until run, in nanoseconds
+  uint64_t MaxLatency; //!< longest such wait, in nanoseconds
+} uiMainSourceStats;
+
+/**
+ * @brief A main loop iteration that kept the user interface from responding for longer than the stall threshold; see
+ * @p uiMainSetInstrumentation.
+ */
+typedef struct uiMainStall
+{
+  int64_t      Start;    //!< @p uiMainTime when the iteration started
+  uint64_t     Duration; //!< in nanoseconds
+  uiMainSource Culprit;  //!< the source that took the largest part of it
+} uiMainStall;
+
+/**
+ * @brief Callback for stalls of the main loop.
+ * @param stall @p uiMainStall; only valid during the call
+ * @param data user-defined data
+ */
+typedef void (uiMainStallCallback) (const uiMainStall *stall, void *data);
+
+/**
+ * @brief Turns main loop instrumentation on or off.
+ * @param enable non-zero to collect counters and stalls
+ * @param stallThreshold iterations taking longer than this many nanoseconds are stalls; 0 to not track stalls
+ * @remark Off by default; it takes the time twice for every callback. Turning it on resets the counters and forgets
+ * earlier stalls.
+ */
+API void uiMainSetInstrumentation (int enable, uint64_t stallThreshold);
+
+/**
+ * @brief Gets the main loop counters of one source.
+ * @param source @p uiMainSource
+ * @param[out] stats counters since instrumentation was turned on
+ */
+API void uiMainSourceStatistics (uiMainSource source, uiMainSourceStats *stats);
+
+/**
+ * @brief Gets the most recent stalls of the main loop.
+ * @param[out] stalls array receiving up to @p n stalls, oldest first
+ * @param n size of @p stalls
+ * @return the number of stalls since instrumentation was turned on, which may be more than @p n; only the last 64 are
+ * kept
+ */
+API size_t uiMainStalls (uiMainStall *stalls, size_t n);
+
+/**
+ * @brief Registers a function to call after every stall of the main loop, e.g. to report jank from production builds.
+ * @param f pointer to the callback function, or @p NULL
+ * @param data to pass to the callback function
+ */
+API void uiMainOnStall (uiMainStallCallback *f, void *data);
+#endif
+
 /**
  * @brief Instructs LibUI to exit the main loop.
  */
@@ -32,9 +142,124 @@ API void uiQuit (void);
  * @brief Queues a function to run on the UI thread
  * @param f pointer to the callback function
  * @param data to pass to the callback function
+ * @remark Safe to call from any thread. Functions run in the order they were queued. Queueing is cheap enough for
+ * frequent progress updates: calls queued close together are run in one batch, and a large batch is spread over
+ * several main loop iterations so the user interface stays responsive.
  */
 API void uiQueueMain (uiQueueCallback *f, void *data);
 
+#ifdef uiBackendUnix
+/**
+ * @brief Queues a function to run on the UI thread, replacing the data of a call with the same key that has not run
+ * yet.
+ * @param key identifies what the call updates, e.g. the address of the progress bar it sets; @p NULL queues the call
+ * like @p uiQueueMain
+ * @param f pointer to the callback function
+ * @param data to pass to the callback function
+ * @param discard called with data that will never reach @p f, or @p NULL; runs on the thread that replaced it
+ * @remark Meant for updates where only the latest value matters: however many calls a worker makes before the UI
+ * thread gets to them, @p f runs once, with the newest data. A replaced call keeps its place in the queue.
+ */
+API void uiQueueMainCoalesced (const void *key, uiQueueCallback *f, void *data, uiQueueCallback *discard);
+
+/**
+ * @brief Events of a file descriptor watched with @p uiMainWatchFD.
+ */
+typedef enum uiWatchFDEvents
+{
+  uiWatchFDRead   = 1 << 0, //!< data can be read, or a connection accepted
+  uiWatchFDWrite  = 1 << 1, //!< data can be written
+  uiWatchFDHangup = 1 << 2, //!< the other end was closed; always reported, whether asked for or not
+  uiWatchFDError  = 1 << 3, //!< an error is pending; always reported, whether asked for or not
+  uiWatchFDEdge   = 1 << 4, //!< not an event: report events once, until @p uiMainWatchFDRearm is called
+} uiWatchFDEvents;
+
+/**
+ * @brief A file descriptor watch; see @p uiMainWatchFD.
+ */
+typedef struct uiFDWatch uiFDWatch;
+
+/**
+ * @brief Callback for file descriptor watches.
+ * @param w @p uiFDWatch
+ * @param fd the watched file descriptor
+ * @param events the @p uiWatchFDEvents that happened
+ * @param data user-defined data
+ * @return non-zero to keep watching
+ */
+typedef int (uiWatchFDCallback) (uiFDWatch *w, int fd, int events, void *data);
+
+/**
+ * @brief Calls a function on the UI thread whenever a file descriptor is ready, e.g. a socket, a pipe, or an inotify
+ * descriptor.
+ * @param fd file descriptor; not closed by libui
+ * @param events @p uiWatchFDEvents to wait for, e.g. @p uiWatchFDRead
+ * @param f pointer to the callback function
+ * @param data to pass to the callback function
+ * @return @p uiFDWatch, valid until @p f returns zero or the watch is removed with @p uiMainUnwatchFD
+ * @remark By default the watch is level-triggered: @p f is called on every main loop iteration for as long as the
+ * descriptor stays ready, so it may read as little as it likes at a time. With @p uiWatchFDEdge, @p f is called once
+ * and the watch then waits for @p uiMainWatchFDRearm; typically @p f reads until the descriptor would block, and
+ * rearms.
+ * @remark The descriptor is polled by the main loop itself, so no thread is needed and no event goes through
+ * @p uiQueueMain.
+ */
+API uiFDWatch *uiMainWatchFD (int fd, int events, uiWatchFDCallback *f, void *data);
+
+/**
+ * @brief Lets an edge-triggered watch report events again.
+ * @param w @p uiFDWatch
+ * @remark Does nothing for level-triggered watches and for watches that are armed already. Can be called from the
+ * watch's own callback.
+ */
+API void uiMainWatchFDRearm (uiFDWatch *w);
+
+/**
+ * @brief Stops watching a file descriptor and frees @p w.
+ * @param w @p uiFDWatch
+ * @remark Can be called from the watch's own callback; the callback's return value is then ignored.
+ */
+API void uiMainUnwatchFD (uiFDWatch *w);
+
+/**
+ * @brief Priorities of @p uiQueueIdle work. All of them come after input, painting, and @p uiQueueMain calls.
+ */
+typedef enum uiIdlePriority
+{
+  uiIdlePriorityHigh,   //!< work the user will likely need soon, e.g. the rows just outside the visible part of a table
+  uiIdlePriorityNormal, //!< the default
+  uiIdlePriorityLow,    //!< work that can wait, e.g. warming caches
+} uiIdlePriority;
+
+/**
+ * @brief Callback for idle work.
+ * @param data user-defined data
+ * @return non-zero if there is more work to do; the callback is then called again later
+ */
+typedef int (uiIdleCallback) (void *data);
+
+/**
+ * @brief Queues work to run on the UI thread when it has nothing better to do.
+ * @param priority @p uiIdlePriority
+ * @param f pointer to the callback function
+ * @param data to pass to the callback function
+ * @remark Only call from the UI thread.
+ * @remark Meant for lazy work such as measuring column widths or building caches: @p f should do a small piece of the
+ * work and return non-zero until it is all done. Idle work runs in time slices (see @p uiQueueIdleSetTimeSlice)
+ * between which the main loop handles input and paints, and higher priorities run first. Work of the same priority
+ * takes turns.
+ * @remark Work still queued when @p uiUninit runs is dropped.
+ */
+API void uiQueueIdle (uiIdlePriority priority, uiIdleCallback *f, void *data);
+
+/**
+ * @brief Sets how long idle work may run before the main loop gets control back.
+ * @param milliseconds length of a time slice; 4 by default, which leaves most of a frame for painting
+ * @remark A callback is never interrupted; a slice ends after the first callback that goes past it.
+ */
+API void uiQueueIdleSetTimeSlice (int milliseconds);
+#endif
+
 /**
  * @brief Registers a callback to invoke when the user-interface is about to shutdown
  * @param f pointer to the callback function
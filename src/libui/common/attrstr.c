@@ -2,6 +2,7 @@
 #include "uipriv.h"
 #include "utf.h"
 
+#include <stdatomic.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -22,8 +23,22 @@ struct uiAttributedString
 
   // this is lazily created to keep things from getting *too* slow
   uiprivGraphemes *graphemes;
+
+  // changes on every modification; see uiprivAttributedStringRevision()
+  uint64_t revision;
 };
 
+// shared by all strings, so no two strings or versions of a string ever have the same revision; atomic because strings
+// are also edited from draw handlers running on area tile workers
+static atomic_uint_fast64_t nextRevision = 0;
+
+static void
+touch (const uiAttributedString *s)
+{
+  // attributes can be set on a const string; the revision is bookkeeping, not content
+  ((uiAttributedString *)s)->revision = atomic_fetch_add_explicit (&nextRevision, 1, memory_order_relaxed) + 1;
+}
+
 static void
 resize (uiAttributedString *s, const size_t u8, const size_t u16)
 {
@@ -46,6 +61,7 @@ uiNewAttributedString (const char *initialString)
 {
   uiAttributedString *s = uiprivNew (uiAttributedString);
   s->attrs              = uiprivNewAttrList ();
+  touch (s);
   uiAttributedStringAppendUnattributed (s, initialString);
   return s;
 }
@@ -210,6 +226,7 @@ uiAttributedStringInsertAtUnattributed (uiAttributedString *s, const char *str,
 
   // and finally do the attributes
   uiprivAttrListInsertCharactersUnattributed (s->attrs, at, n8);
+  touch (s);
 }
 
 void
@@ -249,12 +266,14 @@ uiAttributedStringDelete (uiAttributedString *s, const size_t start, const size_
 
   // and finally resize
   resize (s, s->len - count, s->u16len - count16);
+  touch (s);
 }
 
 void
 uiAttributedStringSetAttribute (const uiAttributedString *s, uiAttribute *a, const size_t start, const size_t end)
 {
   uiprivAttrListInsertAttribute (s->attrs, a, start, end);
+  touch (s);
 }
 
 void
@@ -329,3 +348,9 @@ uiprivAttributedStringCopyUTF16ToUTF8Table (const uiAttributedString *s, size_t
   memmove (out, s->u16tou8, nbytes);
   return out;
 }
+
+uint64_t
+uiprivAttributedStringRevision (const uiAttributedString *s)
+{
+  return s->revision;
+}
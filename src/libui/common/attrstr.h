@@ -33,6 +33,13 @@ API size_t uiprivAttributedStringUTF8ToUTF16 (const uiAttributedString *s, size_
 
 API const uint16_t *uiprivAttributedStringUTF16String (const uiAttributedString *s);
 
+/**
+ * @brief Identifies the contents of a string.
+ * @return a value that changes whenever the text or attributes of @p s change, and that no other string has had
+ * @remark Meant for caches of things derived from the string, such as text layouts.
+ */
+API uint64_t uiprivAttributedStringRevision (const uiAttributedString *s);
+
 API int uiprivGraphemesTakesUTF16 (void);
 
 API int uiprivOpenTypeFeaturesEqual (const uiOpenTypeFeatures *a, const uiOpenTypeFeatures *b);
@@ -0,0 +1,384 @@
+#include "uipriv.h"
+
+#include <ui/hit_index.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Number of children of every node of the tree.
+ */
+#define FANOUT 16
+
+/**
+ * @brief Deepest possible tree; 16^16 shapes is more than anyone can allocate.
+ */
+#define MAX_DEPTH 16
+
+/**
+ * @brief An axis-aligned bounding box; the first member of both items and nodes, so one comparator sorts either.
+ */
+struct box
+{
+  double x0;
+  double y0;
+  double x1;
+  double y1;
+};
+
+struct item
+{
+  struct box         box;
+  uintptr_t          id;
+  size_t             seq;  //!< insertion order; later items are on top
+  uiDrawPath        *path; //!< NULL for rectangles; only set where uiHitIndexAddPath exists
+  int                stroked;
+  uiDrawStrokeParams stroke; //!< Dashes points to our own copy
+};
+
+/**
+ * @brief A node of the tree.
+ *
+ * The tree is a packed Sort-Tile-Recursive R-tree: it is bulk-loaded from scratch whenever it is out of date, which
+ * gives well-shaped nodes and lets it live in two flat arrays. Leaves cover a run of @p items; inner nodes cover a run
+ * of the nodes of the level below.
+ */
+struct node
+{
+  struct box box;
+  size_t     first;
+  size_t     count;
+  int        leaf;
+};
+
+struct uiHitIndex
+{
+  struct item *items;
+  size_t       nItems;
+  size_t       capItems;
+  size_t       seq;
+  struct node *nodes;
+  size_t       nNodes;
+  int          dirty;
+};
+
+uiHitIndex *
+uiNewHitIndex (void)
+{
+  return uiprivNew (uiHitIndex);
+}
+
+void
+uiHitIndexClear (uiHitIndex *idx)
+{
+  for (size_t i = 0; i < idx->nItems; i++)
+    if (idx->items[i].stroke.Dashes != NULL)
+      uiprivFree (idx->items[i].stroke.Dashes);
+  idx->nItems = 0;
+  idx->seq    = 0;
+  idx->dirty  = 1;
+}
+
+void
+uiFreeHitIndex (uiHitIndex *idx)
+{
+  uiHitIndexClear (idx);
+  if (idx->items != NULL)
+    uiprivFree (idx->items);
+  if (idx->nodes != NULL)
+    uiprivFree (idx->nodes);
+  uiprivFree (idx);
+}
+
+static struct item *
+addItem (uiHitIndex *idx, const uintptr_t id)
+{
+  struct item *it;
+
+  if (idx->nItems == idx->capItems)
+    {
+      idx->capItems = idx->capItems == 0 ? 64 : idx->capItems * 2;
+      idx->items    = uiprivRealloc (idx->items, idx->capItems * sizeof (struct item), "struct item[]");
+    }
+  it = &idx->items[idx->nItems++];
+  memset (it, 0, sizeof (struct item));
+  it->id     = id;
+  it->seq    = idx->seq++;
+  idx->dirty = 1;
+  return it;
+}
+
+/**
+ * @brief Makes the box of a rectangle; a negative width or height extends it to the left or up.
+ */
+static struct box
+makeBox (const double x, const double y, const double width, const double height)
+{
+  struct box b = { x, y, x + width, y + height };
+  double     t;
+
+  if (b.x1 < b.x0)
+    {
+      t    = b.x0;
+      b.x0 = b.x1;
+      b.x1 = t;
+    }
+  if (b.y1 < b.y0)
+    {
+      t    = b.y0;
+      b.y0 = b.y1;
+      b.y1 = t;
+    }
+  return b;
+}
+
+void
+uiHitIndexAddRectangle (uiHitIndex *idx, const uintptr_t id, const double x, const double y, const double width,
+                        const double height)
+{
+  struct item *it = addItem (idx, id);
+
+  it->box = makeBox (x, y, width, height);
+}
+
+#ifdef uiBackendUnix
+void
+uiHitIndexAddPath (uiHitIndex *idx, const uintptr_t id, uiDrawPath *path, const uiDrawStrokeParams *stroke)
+{
+  struct item *it = addItem (idx, id);
+  double       x;
+  double       y;
+  double       width;
+  double       height;
+
+  it->path = path;
+  if (stroke != NULL)
+    {
+      it->stroked = 1;
+      it->stroke  = *stroke;
+      if (stroke->NumDashes != 0)
+        {
+          it->stroke.Dashes = uiprivAlloc (stroke->NumDashes * sizeof (double), "double[]");
+          memcpy (it->stroke.Dashes, stroke->Dashes, stroke->NumDashes * sizeof (double));
+        }
+      else
+        it->stroke.Dashes = NULL;
+    }
+  uiDrawPathBounds (path, it->stroked ? &it->stroke : NULL, &x, &y, &width, &height);
+  it->box = makeBox (x, y, width, height);
+}
+#endif
+
+static int
+compareCenterX (const void *a, const void *b)
+{
+  const struct box *ba = a;
+  const struct box *bb = b;
+  const double      ca = ba->x0 + ba->x1;
+  const double      cb = bb->x0 + bb->x1;
+
+  return (ca > cb) - (ca < cb);
+}
+
+static int
+compareCenterY (const void *a, const void *b)
+{
+  const struct box *ba = a;
+  const struct box *bb = b;
+  const double      ca = ba->y0 + ba->y1;
+  const double      cb = bb->y0 + bb->y1;
+
+  return (ca > cb) - (ca < cb);
+}
+
+/**
+ * @brief Orders boxes so that every run of @p FANOUT of them is spatially compact: sort by x, cut into vertical
+ * slices of whole runs, and sort every slice by y.
+ * @param base array of structures starting with a @p struct box
+ * @param n number of elements
+ * @param size size of an element
+ */
+static void
+strSort (void *base, const size_t n, const size_t size)
+{
+  const size_t runs      = (n + FANOUT - 1) / FANOUT;
+  const size_t slices    = (size_t)ceil (sqrt ((double)runs));
+  const size_t sliceSize = slices * FANOUT;
+
+  qsort (base, n, size, compareCenterX);
+  for (size_t i = 0; i < n; i += sliceSize)
+    qsort ((char *)base + i * size, n - i < sliceSize ? n - i : sliceSize, size, compareCenterY);
+}
+
+static void
+unionBox (struct box *dst, const struct box *src)
+{
+  if (src->x0 < dst->x0)
+    dst->x0 = src->x0;
+  if (src->y0 < dst->y0)
+    dst->y0 = src->y0;
+  if (src->x1 > dst->x1)
+    dst->x1 = src->x1;
+  if (src->y1 > dst->y1)
+    dst->y1 = src->y1;
+}
+
+/**
+ * @brief Groups runs of @p FANOUT children into new nodes appended to @p idx->nodes.
+ * @param children first child; an item or a node
+ * @param stride size of a child
+ * @param first index of the first child
+ * @param n number of children
+ * @param leaf whether the children are items
+ */
+static void
+addLevel (uiHitIndex *idx, const char *children, const size_t stride, const size_t first, const size_t n,
+          const int leaf)
+{
+  for (size_t i = 0; i < n; i += FANOUT)
+    {
+      struct node *node = &idx->nodes[idx->nNodes++];
+
+      node->box   = *(const struct box *)(children + i * stride);
+      node->first = first + i;
+      node->count = n - i < FANOUT ? n - i : FANOUT;
+      node->leaf  = leaf;
+      for (size_t j = 1; j < node->count; j++)
+        unionBox (&node->box, (const struct box *)(children + (i + j) * stride));
+    }
+}
+
+static void
+rebuild (uiHitIndex *idx)
+{
+  size_t maxNodes = 0;
+  size_t level;
+  size_t levelSize;
+
+  idx->dirty  = 0;
+  idx->nNodes = 0;
+  if (idx->nItems == 0)
+    return;
+
+  for (size_t n = idx->nItems; n > 1; n = (n + FANOUT - 1) / FANOUT)
+    maxNodes += (n + FANOUT - 1) / FANOUT;
+  if (maxNodes == 0)
+    maxNodes = 1;
+  if (idx->nodes != NULL)
+    uiprivFree (idx->nodes);
+  idx->nodes = uiprivAlloc (maxNodes * sizeof (struct node), "struct node[]");
+
+  strSort (idx->items, idx->nItems, sizeof (struct item));
+  addLevel (idx, (const char *)idx->items, sizeof (struct item), 0, idx->nItems, 1);
+
+  // every level is sorted in place before its parents are made; the parents refer to it by index, and its own
+  // children were sorted already, so nothing else needs fixing up
+  level     = 0;
+  levelSize = idx->nNodes;
+  while (levelSize > 1)
+    {
+      strSort (&idx->nodes[level], levelSize, sizeof (struct node));
+      addLevel (idx, (const char *)&idx->nodes[level], sizeof (struct node), level, levelSize, 0);
+      level += levelSize;
+      levelSize = idx->nNodes - level;
+    }
+}
+
+static int
+boxContains (const struct box *b, const double x, const double y)
+{
+  return x >= b->x0 && x <= b->x1 && y >= b->y0 && y <= b->y1;
+}
+
+static int
+boxIntersects (const struct box *a, const struct box *b)
+{
+  return a->x0 <= b->x1 && b->x0 <= a->x1 && a->y0 <= b->y1 && b->y0 <= a->y1;
+}
+
+int
+uiHitIndexHitTest (uiHitIndex *idx, const double x, const double y, uintptr_t *id)
+{
+  size_t             stack[MAX_DEPTH * FANOUT];
+  size_t             top  = 0;
+  const struct item *best = NULL;
+
+  if (idx->dirty)
+    rebuild (idx);
+  if (idx->nNodes == 0)
+    return 0;
+
+  stack[top++] = idx->nNodes - 1;
+  while (top != 0)
+    {
+      const struct node *node = &idx->nodes[stack[--top]];
+
+      if (!boxContains (&node->box, x, y))
+        continue;
+      if (!node->leaf)
+        {
+          for (size_t i = 0; i < node->count; i++)
+            stack[top++] = node->first + i;
+          continue;
+        }
+      for (size_t i = 0; i < node->count; i++)
+        {
+          const struct item *it = &idx->items[node->first + i];
+
+          // the exact test is the expensive part, so skip it for anything below what we already found
+          if (best != NULL && it->seq < best->seq)
+            continue;
+          if (!boxContains (&it->box, x, y))
+            continue;
+#ifdef uiBackendUnix
+          if (it->path != NULL && !uiDrawPathContainsPoint (it->path, it->stroked ? &it->stroke : NULL, x, y))
+            continue;
+#endif
+          best = it;
+        }
+    }
+
+  if (best == NULL)
+    return 0;
+  *id = best->id;
+  return 1;
+}
+
+size_t
+uiHitIndexQueryRectangle (uiHitIndex *idx, const double x, const double y, const double width, const double height,
+                          uintptr_t *ids, const size_t n)
+{
+  size_t           stack[MAX_DEPTH * FANOUT];
+  size_t           top   = 0;
+  size_t           found = 0;
+  const struct box query = makeBox (x, y, width, height);
+
+  if (idx->dirty)
+    rebuild (idx);
+  if (idx->nNodes == 0)
+    return 0;
+
+  stack[top++] = idx->nNodes - 1;
+  while (top != 0)
+    {
+      const struct node *node = &idx->nodes[stack[--top]];
+
+      if (!boxIntersects (&node->box, &query))
+        continue;
+      for (size_t i = 0; i < node->count; i++)
+        {
+          if (!node->leaf)
+            {
+              stack[top++] = node->first + i;
+              continue;
+            }
+          if (!boxIntersects (&idx->items[node->first + i].box, &query))
+            continue;
+          if (found < n)
+            ids[found] = idx->items[node->first + i].id;
+          found++;
+        }
+    }
+  return found;
+}
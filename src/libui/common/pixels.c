@@ -0,0 +1,248 @@
+#include "uipriv.h"
+
+#include <stdint.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PIXELS_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PIXELS_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#if defined(__ARM_NEON) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define PIXELS_NEON
+#include <arm_neon.h>
+#endif
+
+/**
+ * @brief Converts one row of pixels.
+ * @param dst native-endian ARGB32 output
+ * @param src [R G B A] input
+ * @param width in pixels
+ * @param premultiply non-zero to multiply the color channels by alpha
+ */
+typedef void (*convertRowFunc) (uint8_t *dst, const uint8_t *src, int width, int premultiply);
+
+/**
+ * @brief Computes @code round(c * a / 255)@endcode without a division.
+ */
+static uint32_t
+mul255 (const uint32_t c, const uint32_t a)
+{
+  const uint32_t t = c * a + 128;
+
+  return (t + (t >> 8)) >> 8;
+}
+
+static void
+convertRowScalar (uint8_t *dst, const uint8_t *src, const int width, const int premultiply)
+{
+  uint32_t *out = (uint32_t *)dst;
+
+  for (int x = 0; x < width; x++, src += 4)
+    {
+      uint32_t r = src[0];
+      uint32_t g = src[1];
+      uint32_t b = src[2];
+      uint32_t a = src[3];
+
+      if (premultiply)
+        {
+          r = mul255 (r, a);
+          g = mul255 (g, a);
+          b = mul255 (b, a);
+        }
+
+      // storing whole words takes care of the platform's byte order
+      out[x] = a << 24 | r << 16 | g << 8 | b;
+    }
+}
+
+#ifdef PIXELS_SSE2
+
+// On little-endian systems, ARGB32 is [B G R A] in memory, so the conversion swaps the R and B bytes of every pixel.
+// The premultiply step widens to 16 bits, multiplies every channel by a broadcast of its pixel's alpha, and then puts
+// the original alpha bytes back.
+
+static __m128i
+swizzleSSE2 (const __m128i px)
+{
+  const __m128i ag = _mm_and_si128 (px, _mm_set1_epi32 ((int)0xFF00FF00));
+  __m128i       rb = _mm_and_si128 (px, _mm_set1_epi32 (0x00FF00FF));
+
+  rb = _mm_shufflelo_epi16 (rb, _MM_SHUFFLE (2, 3, 0, 1));
+  rb = _mm_shufflehi_epi16 (rb, _MM_SHUFFLE (2, 3, 0, 1));
+  return _mm_or_si128 (ag, rb);
+}
+
+static __m128i
+mul255SSE2 (const __m128i c)
+{
+  __m128i a = _mm_shufflelo_epi16 (c, _MM_SHUFFLE (3, 3, 3, 3));
+  __m128i t;
+
+  a = _mm_shufflehi_epi16 (a, _MM_SHUFFLE (3, 3, 3, 3));
+  t = _mm_add_epi16 (_mm_mullo_epi16 (c, a), _mm_set1_epi16 (128));
+  return _mm_srli_epi16 (_mm_add_epi16 (t, _mm_srli_epi16 (t, 8)), 8);
+}
+
+static __m128i
+premultiplySSE2 (const __m128i px)
+{
+  const __m128i zero  = _mm_setzero_si128 ();
+  const __m128i alpha = _mm_set1_epi32 ((int)0xFF000000);
+  const __m128i lo    = mul255SSE2 (_mm_unpacklo_epi8 (px, zero));
+  const __m128i hi    = mul255SSE2 (_mm_unpackhi_epi8 (px, zero));
+  const __m128i out   = _mm_packus_epi16 (lo, hi);
+
+  return _mm_or_si128 (_mm_andnot_si128 (alpha, out), _mm_and_si128 (alpha, px));
+}
+
+static void
+convertRowSSE2 (uint8_t *dst, const uint8_t *src, const int width, const int premultiply)
+{
+  int x = 0;
+
+  for (; x + 4 <= width; x += 4)
+    {
+      __m128i px = swizzleSSE2 (_mm_loadu_si128 ((const __m128i *)(src + x * 4)));
+
+      if (premultiply)
+        px = premultiplySSE2 (px);
+      _mm_storeu_si128 ((__m128i *)(dst + x * 4), px);
+    }
+  convertRowScalar (dst + x * 4, src + x * 4, width - x, premultiply);
+}
+
+#endif
+
+#ifdef PIXELS_AVX2
+
+// The same as the SSE2 version; every AVX2 instruction used here works on each 128-bit half separately, which keeps
+// the pixels in order.
+
+__attribute__ ((target ("avx2"))) static __m256i
+mul255AVX2 (const __m256i c)
+{
+  __m256i a = _mm256_shufflelo_epi16 (c, _MM_SHUFFLE (3, 3, 3, 3));
+  __m256i t;
+
+  a = _mm256_shufflehi_epi16 (a, _MM_SHUFFLE (3, 3, 3, 3));
+  t = _mm256_add_epi16 (_mm256_mullo_epi16 (c, a), _mm256_set1_epi16 (128));
+  return _mm256_srli_epi16 (_mm256_add_epi16 (t, _mm256_srli_epi16 (t, 8)), 8);
+}
+
+__attribute__ ((target ("avx2"))) static void
+convertRowAVX2 (uint8_t *dst, const uint8_t *src, const int width, const int premultiply)
+{
+  const __m256i agMask = _mm256_set1_epi32 ((int)0xFF00FF00);
+  const __m256i rbMask = _mm256_set1_epi32 (0x00FF00FF);
+  const __m256i alpha  = _mm256_set1_epi32 ((int)0xFF000000);
+  const __m256i zero   = _mm256_setzero_si256 ();
+  int           x      = 0;
+
+  for (; x + 8 <= width; x += 8)
+    {
+      const __m256i in = _mm256_loadu_si256 ((const __m256i *)(src + x * 4));
+      __m256i       rb = _mm256_and_si256 (in, rbMask);
+      __m256i       px;
+
+      rb = _mm256_shufflelo_epi16 (rb, _MM_SHUFFLE (2, 3, 0, 1));
+      rb = _mm256_shufflehi_epi16 (rb, _MM_SHUFFLE (2, 3, 0, 1));
+      px = _mm256_or_si256 (_mm256_and_si256 (in, agMask), rb);
+
+      if (premultiply)
+        {
+          const __m256i lo  = mul255AVX2 (_mm256_unpacklo_epi8 (px, zero));
+          const __m256i hi  = mul255AVX2 (_mm256_unpackhi_epi8 (px, zero));
+          const __m256i out = _mm256_packus_epi16 (lo, hi);
+
+          px = _mm256_or_si256 (_mm256_andnot_si256 (alpha, out), _mm256_and_si256 (alpha, px));
+        }
+      _mm256_storeu_si256 ((__m256i *)(dst + x * 4), px);
+    }
+  convertRowSSE2 (dst + x * 4, src + x * 4, width - x, premultiply);
+}
+
+#endif
+
+#ifdef PIXELS_NEON
+
+static uint8x16_t
+mul255NEON (const uint8x16_t c, const uint8x16_t a)
+{
+  const uint16x8_t lo = vmull_u8 (vget_low_u8 (c), vget_low_u8 (a));
+  const uint16x8_t hi = vmull_u8 (vget_high_u8 (c), vget_high_u8 (a));
+
+  // (t + ((t + 128) >> 8) + 128) >> 8, the same rounding as mul255()
+  return vcombine_u8 (vraddhn_u16 (lo, vrshrq_n_u16 (lo, 8)), vraddhn_u16 (hi, vrshrq_n_u16 (hi, 8)));
+}
+
+static void
+convertRowNEON (uint8_t *dst, const uint8_t *src, const int width, const int premultiply)
+{
+  int x = 0;
+
+  // vld4q_u8() splits the channels into separate registers, so the swizzle is just the order of the store
+  for (; x + 16 <= width; x += 16)
+    {
+      const uint8x16x4_t in = vld4q_u8 (src + x * 4);
+      uint8x16x4_t       out;
+
+      out.val[0] = in.val[2];
+      out.val[1] = in.val[1];
+      out.val[2] = in.val[0];
+      out.val[3] = in.val[3];
+      if (premultiply)
+        {
+          out.val[0] = mul255NEON (out.val[0], in.val[3]);
+          out.val[1] = mul255NEON (out.val[1], in.val[3]);
+          out.val[2] = mul255NEON (out.val[2], in.val[3]);
+        }
+      vst4q_u8 (dst + x * 4, out);
+    }
+  convertRowScalar (dst + x * 4, src + x * 4, width - x, premultiply);
+}
+
+#endif
+
+/**
+ * @brief Picks the fastest row converter the CPU supports.
+ */
+static convertRowFunc
+chooseConvertRow (void)
+{
+#ifdef PIXELS_AVX2
+  if (__builtin_cpu_supports ("avx2"))
+    return convertRowAVX2;
+#endif
+#ifdef PIXELS_SSE2
+  return convertRowSSE2;
+#endif
+#ifdef PIXELS_NEON
+  return convertRowNEON;
+#endif
+  return convertRowScalar;
+}
+
+void
+uiprivRGBAToARGB32 (void *dst, const size_t dstStride, const void *src, const size_t srcStride, const int width,
+                    const int height, const int premultiply)
+{
+  // every choice produces identical output, so racing threads storing the same pointer is harmless
+  static convertRowFunc convertRow = NULL;
+  uint8_t              *out        = dst;
+  const uint8_t        *in         = src;
+
+  if (convertRow == NULL)
+    convertRow = chooseConvertRow ();
+
+  for (int y = 0; y < height; y++)
+    {
+      (*convertRow) (out, in, width, premultiply);
+      out += dstStride;
+      in += srcStride;
+    }
+}
@@ -56,6 +56,20 @@ API void uiprivFallbackTransformSize (const uiDrawMatrix *m, double *x, double *
  */
 API int uiprivStricmp (const char *a, const char *b);
 
+/**
+ * @brief Converts 8-bit [R G B A] pixels to native-endian 32-bit ARGB, the layout of Cairo's @p CAIRO_FORMAT_ARGB32.
+ * @param dst output pixels; must be 4-byte aligned
+ * @param dstStride number of bytes per row of @p dst
+ * @param src input pixels
+ * @param srcStride number of bytes per row of @p src
+ * @param width in pixels
+ * @param height in pixels
+ * @param premultiply non-zero when @p src has straight alpha that must be premultiplied into the color channels
+ * @remark Uses SSE2, AVX2 or NEON where available; the output is identical on every code path.
+ */
+API void uiprivRGBAToARGB32 (void *dst, size_t dstStride, const void *src, size_t srcStride, int width, int height,
+                             int premultiply);
+
 API uiTableModelHandler *uiprivTableModelHandler (const uiTableModel *m);
 
 API uiTableValue *uiprivTableModelCellValue (uiTableModel *m, int row, int column);
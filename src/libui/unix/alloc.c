@@ -2,6 +2,8 @@
 #include <string.h>
 #include "uipriv_unix.h"
 
+// drawing contexts and paths are also allocated on the worker threads that render asynchronous area tiles
+G_LOCK_DEFINE_STATIC(allocations);
 static GPtrArray *allocations;
 
 #define UINT8(p) ((uint8_t *) (p))
@@ -50,7 +52,9 @@ void *uiprivAlloc(size_t size, const char *type)
 	out = g_malloc0(EXTRA + size);
 	*SIZE(out) = size;
 	*TYPE(out) = type;
+	G_LOCK(allocations);
 	g_ptr_array_add(allocations, out);
+	G_UNLOCK(allocations);
 	return DATA(out);
 }
 
@@ -67,9 +71,13 @@ void *uiprivRealloc(void *p, size_t new, const char *type)
 	if (new > *s)
 		memset(((uint8_t *) DATA(out)) + *s, 0, new - *s);
 	*s = new;
-	if (g_ptr_array_remove(allocations, p) == FALSE)
+	G_LOCK(allocations);
+	if (g_ptr_array_remove(allocations, p) == FALSE) {
+		G_UNLOCK(allocations);
 		uiprivImplBug("%p not found in allocations array in uiprivRealloc()", p);
+	}
 	g_ptr_array_add(allocations, out);
+	G_UNLOCK(allocations);
 	return DATA(out);
 }
 
@@ -79,6 +87,10 @@ void uiprivFree(void *p)
 		uiprivImplBug("attempt to uiprivFree(NULL)");
 	p = BASE(p);
 	g_free(p);
-	if (g_ptr_array_remove(allocations, p) == FALSE)
+	G_LOCK(allocations);
+	if (g_ptr_array_remove(allocations, p) == FALSE) {
+		G_UNLOCK(allocations);
 		uiprivImplBug("%p not found in allocations array in uiprivFree()", p);
+	}
+	G_UNLOCK(allocations);
 }
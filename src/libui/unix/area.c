@@ -1,5 +1,6 @@
 // 4 september 2015
 #include "uipriv_unix.h"
+#include "draw.h"
 
 // notes:
 // - G_DECLARE_DERIVABLE/FINAL_INTERFACE() requires glib 2.44 and that's starting with debian stretch (testing) (GTK+ 3.18) and ubuntu 15.04 (GTK+ 3.14) - debian jessie has 2.42 (GTK+ 3.14)
@@ -49,6 +50,32 @@ struct uiArea {
 
 	// for user window drags
 	GdkEventButton *dragevent;
+
+	// for uiAreaOnFrame()
+	int (*onFrame)(uiArea *, const uiAreaFrameInfo *, void *);
+	void *onFrameData;
+	guint tickID;
+	gint64 lastFrameTime;
+	gint64 frameIntervalTotal;
+	uint64_t frameIntervals;
+	uiAreaFrameStats frameStats;
+
+	// for uiAreaSetTileCache(); NULL if disabled
+	uiprivTileCache *tiles;
+	gboolean asyncTiles;
+
+	// for uiAreaSetMotionCoalescing() and uiAreaMotionHistory()
+	gboolean coalesceMotion;
+	guint motionTickID;
+	GArray *motionHistory;		// of uiAreaMotionSample; every motion since the last dispatched one, including it
+	gdouble motionX;
+	gdouble motionY;
+	guint motionState;
+
+	// for uiAreaSetDrawStatistics()
+	uiAreaDrawStatsMode drawStatsMode;
+	uiAreaDrawStats drawStats;		// of the pass in progress, and then of the last pass
+	uiAreaDrawStats drawStatsTotal;
 };
 
 G_DEFINE_TYPE(areaWidget, areaWidget, GTK_TYPE_DRAWING_AREA)
@@ -98,6 +125,103 @@ static void areaWidget_size_allocate(GtkWidget *w, GtkAllocation *allocation)
 		gtk_widget_queue_resize(w);
 }
 
+// the tick callback only exists while there is a frame handler and the area is mapped, so the frame clock stops asking for frames we would throw away
+static gboolean areaWidget_tick(GtkWidget *w, GdkFrameClock *clock, gpointer data);
+
+static void updateTick(uiArea *a)
+{
+	gboolean want;
+
+	want = a->onFrame != NULL && gtk_widget_get_mapped(a->areaWidget);
+	if (want && a->tickID == 0) {
+		// don't count the time we were paused as a frame interval
+		a->lastFrameTime = 0;
+		a->tickID = gtk_widget_add_tick_callback(a->areaWidget, areaWidget_tick, a, NULL);
+	} else if (!want && a->tickID != 0) {
+		gtk_widget_remove_tick_callback(a->areaWidget, a->tickID);
+		a->tickID = 0;
+	}
+}
+
+static void areaWidget_map(GtkWidget *w)
+{
+	GTK_WIDGET_CLASS(areaWidget_parent_class)->map(w);
+	updateTick(areaWidget(w)->a);
+}
+
+static void areaWidget_unmap(GtkWidget *w)
+{
+	uiArea *a = areaWidget(w)->a;
+
+	GTK_WIDGET_CLASS(areaWidget_parent_class)->unmap(w);
+	updateTick(a);
+	// there is no frame coming for pending motion anymore
+	if (a->motionTickID != 0) {
+		gtk_widget_remove_tick_callback(a->areaWidget, a->motionTickID);
+		a->motionTickID = 0;
+		g_array_set_size(a->motionHistory, 0);
+	}
+}
+
+static gboolean iconified(uiArea *a)
+{
+	GdkWindow *gw;
+
+	gw = gtk_widget_get_window(gtk_widget_get_toplevel(a->areaWidget));
+	if (gw == NULL)
+		return FALSE;
+	return (gdk_window_get_state(gw) & GDK_WINDOW_STATE_ICONIFIED) != 0;
+}
+
+static void recordFrame(uiArea *a, gint64 frameTime, gint64 refresh)
+{
+	gint64 interval;
+
+	a->frameStats.Frames++;
+	if (a->lastFrameTime != 0) {
+		interval = frameTime - a->lastFrameTime;
+		a->frameIntervalTotal += interval;
+		a->frameIntervals++;
+		if (interval > a->frameStats.MaxInterval)
+			a->frameStats.MaxInterval = interval;
+		if (refresh != 0 && interval > refresh + refresh / 2)
+			a->frameStats.LateFrames++;
+	}
+	a->lastFrameTime = frameTime;
+}
+
+static gboolean areaWidget_tick(GtkWidget *w, GdkFrameClock *clock, gpointer data)
+{
+	uiArea *a = (uiArea *) data;
+	int (*f)(uiArea *, const uiAreaFrameInfo *, void *);
+	uiAreaFrameInfo fi;
+	gint64 refresh, presentation;
+
+	// some window managers keep minimized windows mapped; the frame clock still ticks for them, but nobody can see the result
+	if (iconified(a)) {
+		a->lastFrameTime = 0;
+		return G_SOURCE_CONTINUE;
+	}
+
+	fi.FrameTime = gdk_frame_clock_get_frame_time(clock);
+	gdk_frame_clock_get_refresh_info(clock, fi.FrameTime, &refresh, &presentation);
+	fi.PresentationTime = presentation;
+	fi.RefreshInterval = refresh;
+	fi.FrameCounter = gdk_frame_clock_get_frame_counter(clock);
+	recordFrame(a, fi.FrameTime, refresh);
+
+	f = a->onFrame;
+	if ((*f)(a, &fi, a->onFrameData))
+		return G_SOURCE_CONTINUE;
+	// if the handler replaced or removed itself, uiAreaOnFrame() already took care of the tick callback
+	if (a->onFrame != f)
+		return G_SOURCE_CONTINUE;
+	a->onFrame = NULL;
+	a->onFrameData = NULL;
+	a->tickID = 0;
+	return G_SOURCE_REMOVE;
+}
+
 static void loadAreaSize(uiArea *a, double *width, double *height)
 {
 	GtkAllocation allocation;
@@ -115,6 +239,76 @@ static void loadAreaSize(uiArea *a, double *width, double *height)
 	}
 }
 
+static void beginDrawStats(uiArea *a)
+{
+	if (a->drawStatsMode == uiAreaDrawStatsOff)
+		return;
+	memset(&(a->drawStats), 0, sizeof (uiAreaDrawStats));
+	a->drawStats.Passes = 1;
+}
+
+static void endDrawStats(uiArea *a)
+{
+	uiAreaDrawStats *s = &(a->drawStats);
+	uiAreaDrawStats *t = &(a->drawStatsTotal);
+
+	if (a->drawStatsMode == uiAreaDrawStatsOff)
+		return;
+	t->Passes += s->Passes;
+	t->Fills += s->Fills;
+	t->Strokes += s->Strokes;
+	t->Clips += s->Clips;
+	t->PathSegments += s->PathSegments;
+	t->TextLayouts += s->TextLayouts;
+	t->Patterns += s->Patterns;
+	t->HandlerTime += s->HandlerTime;
+	t->DrawingTime += s->DrawingTime;
+	t->ClipArea += s->ClipArea;
+	if (a->drawStatsMode == uiAreaDrawStatsLog)
+		g_message("uiArea %p: draw pass of %.0f px2 took %" PRIu64 " us in the handler, %" PRIu64 " us drawing; "
+			"%" PRIu64 " fills, %" PRIu64 " strokes, %" PRIu64 " clips, %" PRIu64 " path segments, "
+			"%" PRIu64 " text layouts, %" PRIu64 " new patterns",
+			(void *) a, s->ClipArea, s->HandlerTime / 1000, s->DrawingTime / 1000,
+			s->Fills, s->Strokes, s->Clips, s->PathSegments,
+			s->TextLayouts, s->Patterns);
+}
+
+// runs the Draw handler, counting for uiAreaDrawStatistics() if asked to
+// only call this with count set on the main thread, between beginDrawStats() and endDrawStats()
+static void runDrawHandler(uiArea *a, uiAreaDrawParams *dp, gboolean count)
+{
+	uint64_t start;
+
+	if (!count || a->drawStatsMode == uiAreaDrawStatsOff) {
+		(*(a->ah->Draw))(a->ah, a, dp);
+		return;
+	}
+	dp->Context->stats = &(a->drawStats);
+	start = uiprivDrawStatsNow();
+	(*(a->ah->Draw))(a->ah, a, dp);
+	a->drawStats.HandlerTime += uiprivDrawStatsNow() - start;
+	a->drawStats.ClipArea += dp->ClipWidth * dp->ClipHeight;
+}
+
+// in asynchronous mode this runs on a worker thread, and style is NULL
+static void renderTile(cairo_t *cr, double x, double y, double width, double height, GtkStyleContext *style, void *data)
+{
+	uiArea *a = (uiArea *) data;
+	uiAreaDrawParams dp;
+
+	dp.Context = uiprivNewContext(cr, style);
+	// tiles are only used by scrolling areas, which don't get a size
+	dp.AreaWidth = 0;
+	dp.AreaHeight = 0;
+	dp.ClipX = x;
+	dp.ClipY = y;
+	dp.ClipWidth = width;
+	dp.ClipHeight = height;
+	// worker threads mustn't touch the counters of the pass on the main thread
+	runDrawHandler(a, &dp, style != NULL);
+	uiprivFreeContext(dp.Context);
+}
+
 static gboolean areaWidget_draw(GtkWidget *w, cairo_t *cr)
 {
 	areaWidget *aw = areaWidget(w);
@@ -122,6 +316,13 @@ static gboolean areaWidget_draw(GtkWidget *w, cairo_t *cr)
 	uiAreaDrawParams dp;
 	double clipX0, clipY0, clipX1, clipY1;
 
+	beginDrawStats(a);
+	if (a->tiles != NULL) {
+		uiprivTileCacheDraw(a->tiles, cr);
+		endDrawStats(a);
+		return FALSE;
+	}
+
 	dp.Context = uiprivNewContext(cr,
 		gtk_widget_get_style_context(a->widget));
 
@@ -134,9 +335,10 @@ static gboolean areaWidget_draw(GtkWidget *w, cairo_t *cr)
 	dp.ClipHeight = clipY1 - clipY0;
 
 	// no need to save or restore the graphics state to reset transformations; GTK+ does that for us
-	(*(a->ah->Draw))(a->ah, a, &dp);
+	runDrawHandler(a, &dp, TRUE);
 
 	uiprivFreeContext(dp.Context);
+	endDrawStats(a);
 	return FALSE;
 }
 
@@ -170,15 +372,39 @@ static void areaWidget_get_preferred_width(GtkWidget *w, gint *min, gint *nat)
 	}
 }
 
+// gdk_keymap_add_virtual_modifiers() walks the whole keymap, and motion events come in with the same state over and over, so remember the last answer
+// the answer only changes when the keymap does
+static GdkKeymap *modifierKeymap = NULL;
+static guint modifierState;
+static guint modifierResult;
+static gboolean modifierValid = FALSE;
+
+static void onKeysChanged(GdkKeymap *keymap, gpointer data)
+{
+	modifierValid = FALSE;
+}
+
 static guint translateModifiers(guint state, GdkWindow *window)
 {
+	GdkKeymap *keymap;
 	GdkModifierType statetype;
 
+	keymap = gdk_keymap_get_for_display(gdk_window_get_display(window));
+	if (keymap != modifierKeymap) {
+		// keymaps belong to their display and live as long as it does, so the handler is never disconnected
+		g_signal_connect(keymap, "keys-changed", G_CALLBACK(onKeysChanged), NULL);
+		modifierKeymap = keymap;
+		modifierValid = FALSE;
+	}
+	if (modifierValid && modifierState == state)
+		return modifierResult;
+
 	// GDK doesn't initialize the modifier flags fully; we have to explicitly tell it to (thanks to Daniel_S and daniels (two different people) in irc.gimp.net/#gtk+)
 	statetype = state;
-	gdk_keymap_add_virtual_modifiers(
-		gdk_keymap_get_for_display(gdk_window_get_display(window)),
-		&statetype);
+	gdk_keymap_add_virtual_modifiers(keymap, &statetype);
+	modifierState = state;
+	modifierResult = statetype;
+	modifierValid = TRUE;
 	return statetype;
 }
 
@@ -237,6 +463,52 @@ static void finishMouseEvent(uiArea *a, uiAreaMouseEvent *me, guint mb, gdouble
 	(*(a->ah->MouseEvent))(a->ah, a, me);
 }
 
+static void dispatchMotion(uiArea *a)
+{
+	uiAreaMouseEvent me;
+
+	me.Down = 0;
+	me.Up = 0;
+	me.Count = 0;
+	finishMouseEvent(a, &me, 0, a->motionX, a->motionY, a->motionState, gtk_widget_get_window(a->areaWidget));
+	g_array_set_size(a->motionHistory, 0);
+}
+
+static gboolean motionTick(GtkWidget *w, GdkFrameClock *clock, gpointer data)
+{
+	uiArea *a = (uiArea *) data;
+
+	a->motionTickID = 0;
+	dispatchMotion(a);
+	return G_SOURCE_REMOVE;
+}
+
+// other mouse events must not overtake motion that is still waiting for its frame
+static void flushMotion(uiArea *a)
+{
+	if (a->motionTickID == 0)
+		return;
+	gtk_widget_remove_tick_callback(a->areaWidget, a->motionTickID);
+	a->motionTickID = 0;
+	dispatchMotion(a);
+}
+
+// GDK compresses motion to one event per frame on its own, dropping the events in between; we do the compression ourselves when asked, so turn GDK's off to get the whole history
+static void updateEventCompression(uiArea *a)
+{
+	GdkWindow *window;
+
+	window = gtk_widget_get_window(a->areaWidget);
+	if (window != NULL)
+		uiprivFUTURE_gdk_window_set_event_compression(window, !a->coalesceMotion);
+}
+
+static void areaWidget_realize(GtkWidget *w)
+{
+	GTK_WIDGET_CLASS(areaWidget_parent_class)->realize(w);
+	updateEventCompression(areaWidget(w)->a);
+}
+
 static gboolean areaWidget_button_press_event(GtkWidget *w, GdkEventButton *e)
 {
 	areaWidget *aw = areaWidget(w);
@@ -245,6 +517,8 @@ static gboolean areaWidget_button_press_event(GtkWidget *w, GdkEventButton *e)
 	GtkSettings *settings;
 	uiAreaMouseEvent me;
 
+	flushMotion(a);
+
 	// clicking doesn't automatically transfer keyboard focus; we must do so manually (thanks tristan in irc.gimp.net/#gtk+)
 	gtk_widget_grab_focus(w);
 
@@ -282,6 +556,7 @@ static gboolean areaWidget_button_release_event(GtkWidget *w, GdkEventButton *e)
 	uiArea *a = aw->a;
 	uiAreaMouseEvent me;
 
+	flushMotion(a);
 	me.Down = 0;
 	me.Up = e->button;
 	me.Count = 0;
@@ -293,12 +568,21 @@ static gboolean areaWidget_motion_notify_event(GtkWidget *w, GdkEventMotion *e)
 {
 	areaWidget *aw = areaWidget(w);
 	uiArea *a = aw->a;
-	uiAreaMouseEvent me;
-
-	me.Down = 0;
-	me.Up = 0;
-	me.Count = 0;
-	finishMouseEvent(a, &me, 0, e->x, e->y, e->state, e->window);
+	uiAreaMotionSample sample;
+
+	sample.X = e->x;
+	sample.Y = e->y;
+	sample.Time = e->time;
+	g_array_append_val(a->motionHistory, sample);
+	a->motionX = e->x;
+	a->motionY = e->y;
+	a->motionState = e->state;
+	if (!a->coalesceMotion) {
+		dispatchMotion(a);
+		return GDK_EVENT_PROPAGATE;
+	}
+	if (a->motionTickID == 0)
+		a->motionTickID = gtk_widget_add_tick_callback(w, motionTick, a, NULL);
 	return GDK_EVENT_PROPAGATE;
 }
 
@@ -308,6 +592,7 @@ static gboolean onCrossing(areaWidget *aw, int left)
 {
 	uiArea *a = aw->a;
 
+	flushMotion(a);
 	(*(a->ah->MouseCrossed))(a->ah, a, left);
 	uiprivClickCounterReset(a->cc);
 	return GDK_EVENT_PROPAGATE;
@@ -475,6 +760,9 @@ static void areaWidget_class_init(areaWidgetClass *class)
 
 	GTK_WIDGET_CLASS(class)->size_allocate = areaWidget_size_allocate;
 	GTK_WIDGET_CLASS(class)->draw = areaWidget_draw;
+	GTK_WIDGET_CLASS(class)->realize = areaWidget_realize;
+	GTK_WIDGET_CLASS(class)->map = areaWidget_map;
+	GTK_WIDGET_CLASS(class)->unmap = areaWidget_unmap;
 	GTK_WIDGET_CLASS(class)->get_preferred_height = areaWidget_get_preferred_height;
 	GTK_WIDGET_CLASS(class)->get_preferred_width = areaWidget_get_preferred_width;
 	GTK_WIDGET_CLASS(class)->button_press_event = areaWidget_button_press_event;
@@ -494,7 +782,19 @@ static void areaWidget_class_init(areaWidgetClass *class)
 
 // control implementation
 
-uiUnixControlAllDefaults(uiArea)
+uiUnixControlAllDefaultsExceptDestroy(uiArea)
+
+static void uiAreaDestroy(uiControl *c)
+{
+	uiArea *a = uiArea(c);
+
+	if (a->tiles != NULL)
+		uiprivFreeTileCache(a->tiles);
+	g_object_unref(a->widget);
+	// unreffing the widget can still unmap it, and the unmap handler uses this
+	g_array_free(a->motionHistory, TRUE);
+	uiFreeControl(uiControl(a));
+}
 
 void uiAreaSetSize(uiArea *a, int width, int height)
 {
@@ -502,14 +802,115 @@ void uiAreaSetSize(uiArea *a, int width, int height)
 		uiprivUserBug("You cannot call uiAreaSetSize() on a non-scrolling uiArea. (area: %p)", a);
 	a->scrollWidth = width;
 	a->scrollHeight = height;
+	if (a->tiles != NULL)
+		uiprivTileCacheInvalidateAll(a->tiles);
 	gtk_widget_queue_resize(a->areaWidget);
 }
 
 void uiAreaQueueRedrawAll(uiArea *a)
 {
+	if (a->tiles != NULL)
+		uiprivTileCacheInvalidateAll(a->tiles);
+	gtk_widget_queue_draw(a->areaWidget);
+}
+
+void uiAreaInvalidateRect(uiArea *a, double x, double y, double width, double height)
+{
+	int x0, y0, x1, y1;
+
+	if (a->tiles != NULL)
+		uiprivTileCacheInvalidate(a->tiles, x, y, width, height);
+	x0 = (int) floor(x);
+	y0 = (int) floor(y);
+	x1 = (int) ceil(x + width);
+	y1 = (int) ceil(y + height);
+	gtk_widget_queue_draw_area(a->areaWidget, x0, y0, x1 - x0, y1 - y0);
+}
+
+void uiAreaSetTileCache(uiArea *a, int tileSize, size_t budget)
+{
+	if (!a->scrolling)
+		uiprivUserBug("You cannot call uiAreaSetTileCache() on a non-scrolling uiArea. (area: %p)", a);
+	if (tileSize < 0)
+		uiprivUserBug("Invalid tile size %d passed to uiAreaSetTileCache(). (area: %p)", tileSize, a);
+	if (a->tiles != NULL) {
+		uiprivFreeTileCache(a->tiles);
+		a->tiles = NULL;
+	}
+	if (tileSize != 0) {
+		a->tiles = uiprivNewTileCache(a->areaWidget, tileSize, budget, renderTile, a);
+		uiprivTileCacheSetAsync(a->tiles, a->asyncTiles);
+	}
+	gtk_widget_queue_draw(a->areaWidget);
+}
+
+void uiAreaSetAsyncTileRendering(uiArea *a, int async)
+{
+	if (!a->scrolling)
+		uiprivUserBug("You cannot call uiAreaSetAsyncTileRendering() on a non-scrolling uiArea. (area: %p)", a);
+	a->asyncTiles = async != 0;
+	if (a->tiles != NULL)
+		uiprivTileCacheSetAsync(a->tiles, a->asyncTiles);
 	gtk_widget_queue_draw(a->areaWidget);
 }
 
+void uiAreaOnFrame(uiArea *a, int (*f)(uiArea *, const uiAreaFrameInfo *, void *), void *data)
+{
+	if (f != NULL && f != a->onFrame) {
+		memset(&(a->frameStats), 0, sizeof (uiAreaFrameStats));
+		a->frameIntervalTotal = 0;
+		a->frameIntervals = 0;
+		a->lastFrameTime = 0;
+	}
+	a->onFrame = f;
+	a->onFrameData = data;
+	if (f == NULL)
+		a->onFrameData = NULL;
+	updateTick(a);
+}
+
+void uiAreaFrameStatistics(uiArea *a, uiAreaFrameStats *stats)
+{
+	*stats = a->frameStats;
+	stats->AverageInterval = 0;
+	if (a->frameIntervals != 0)
+		stats->AverageInterval = a->frameIntervalTotal / (gint64) (a->frameIntervals);
+}
+
+void uiAreaSetDrawStatistics(uiArea *a, uiAreaDrawStatsMode mode)
+{
+	if (a->drawStatsMode == uiAreaDrawStatsOff && mode != uiAreaDrawStatsOff) {
+		memset(&(a->drawStats), 0, sizeof (uiAreaDrawStats));
+		memset(&(a->drawStatsTotal), 0, sizeof (uiAreaDrawStats));
+	}
+	a->drawStatsMode = mode;
+}
+
+void uiAreaDrawStatistics(uiArea *a, uiAreaDrawStats *last, uiAreaDrawStats *total)
+{
+	if (last != NULL)
+		*last = a->drawStats;
+	if (total != NULL)
+		*total = a->drawStatsTotal;
+}
+
+void uiAreaSetMotionCoalescing(uiArea *a, int coalesce)
+{
+	if (!coalesce)
+		flushMotion(a);
+	a->coalesceMotion = coalesce != 0;
+	updateEventCompression(a);
+}
+
+size_t uiAreaMotionHistory(uiArea *a, uiAreaMotionSample *samples, size_t n)
+{
+	if (n > a->motionHistory->len)
+		n = a->motionHistory->len;
+	if (n != 0)
+		memcpy(samples, a->motionHistory->data, n * sizeof (uiAreaMotionSample));
+	return a->motionHistory->len;
+}
+
 void uiAreaScrollTo(uiArea *a, double x, double y, double width, double height)
 {
 	// TODO
@@ -594,6 +995,7 @@ uiArea *uiNewArea(uiAreaHandler *ah)
 
 	a->ah = ah;
 	a->scrolling = FALSE;
+	a->motionHistory = g_array_new(FALSE, FALSE, sizeof (uiAreaMotionSample));
 
 	a->areaWidget = GTK_WIDGET(g_object_new(areaWidgetType,
 		"libui-area", a,
@@ -614,6 +1016,7 @@ uiArea *uiNewScrollingArea(uiAreaHandler *ah, int width, int height)
 
 	a->ah = ah;
 	a->scrolling = TRUE;
+	a->motionHistory = g_array_new(FALSE, FALSE, sizeof (uiAreaMotionSample));
 	a->scrollWidth = width;
 	a->scrollHeight = height;
 
@@ -0,0 +1,402 @@
+// 19 october 2026
+#include "uipriv_unix.h"
+
+// a tile cache sits between a scrolling uiArea's draw handler and GTK+
+// the canvas is split into fixed-size square tiles in drawing space; each tile is rendered once into an image surface at the widget's scale factor and then just composited until it is invalidated or evicted
+// tiles are kept in least-recently-used order in a GQueue whose links are embedded in the tiles, and are indexed by their position in a GHashTable
+// in asynchronous mode, tiles are rendered on a shared thread pool instead; the main thread only ever composites finished surfaces
+// an invalidated tile then keeps its old surface (marked stale) and is shown until its replacement arrives, so the user sees the previous frame instead of holes
+// everything in uiprivTileCache and struct tile belongs to the main thread; workers only see a tileJob, and finished jobs come back to the main thread through the done queue
+
+struct tile {
+	int x;
+	int y;
+	cairo_surface_t *surface;		// NULL until the first render of an asynchronous tile finishes
+	size_t size;
+	gboolean stale;
+	gboolean pending;
+	guint64 generation;			// renewed on creation and every invalidation, so results rendered from old data are recognized
+	guint64 queued;				// the generation of the job being rendered while pending
+	GList link;
+};
+
+struct uiprivTileCache {
+	int tileSize;
+	size_t budget;
+	size_t used;
+	int scale;
+	gboolean async;
+	GHashTable *tiles;
+	GQueue lru;
+	// only ever increases, so a tile evicted and created again never shares a generation with its old self
+	guint64 generation;
+	GtkWidget *widget;
+	uiprivTileRenderFunc render;
+	void *renderData;
+	// jobs hold references, so a cache freed while its tiles are still being rendered stays around (dead) until they come back
+	int refcount;
+	gint dead;
+	// the render function reads the uiArea, which is gone once the cache is freed; freeing the cache waits until no job is in the render function
+	GMutex lock;
+	GCond idle;
+	int running;
+};
+
+struct tileJob {
+	uiprivTileCache *tc;
+	int x;
+	int y;
+	int scale;
+	guint64 generation;
+	cairo_surface_t *surface;
+};
+
+static GThreadPool *pool = NULL;
+static GAsyncQueue *done = NULL;
+G_LOCK_DEFINE_STATIC(doneSource);
+static guint doneSource = 0;
+
+static guint tileHash(gconstpointer key)
+{
+	const struct tile *t = (const struct tile *) key;
+
+	return ((guint) (t->x)) * 31 + ((guint) (t->y));
+}
+
+static gboolean tileEqual(gconstpointer a, gconstpointer b)
+{
+	const struct tile *ta = (const struct tile *) a;
+	const struct tile *tb = (const struct tile *) b;
+
+	return ta->x == tb->x && ta->y == tb->y;
+}
+
+uiprivTileCache *uiprivNewTileCache(GtkWidget *widget, int tileSize, size_t budget, uiprivTileRenderFunc render, void *renderData)
+{
+	uiprivTileCache *tc;
+
+	tc = uiprivNew(uiprivTileCache);
+	tc->tileSize = tileSize;
+	tc->budget = budget;
+	tc->scale = 1;
+	// the queue owns the tiles; the table only indexes them
+	tc->tiles = g_hash_table_new(tileHash, tileEqual);
+	g_queue_init(&(tc->lru));
+	tc->widget = widget;
+	tc->render = render;
+	tc->renderData = renderData;
+	tc->refcount = 1;
+	g_mutex_init(&(tc->lock));
+	g_cond_init(&(tc->idle));
+	return tc;
+}
+
+static void unrefTileCache(uiprivTileCache *tc)
+{
+	tc->refcount--;
+	if (tc->refcount != 0)
+		return;
+	g_hash_table_destroy(tc->tiles);
+	g_cond_clear(&(tc->idle));
+	g_mutex_clear(&(tc->lock));
+	uiprivFree(tc);
+}
+
+static void removeTile(uiprivTileCache *tc, struct tile *t)
+{
+	g_hash_table_remove(tc->tiles, t);
+	g_queue_unlink(&(tc->lru), &(t->link));
+	tc->used -= t->size;
+	if (t->surface != NULL)
+		cairo_surface_destroy(t->surface);
+	uiprivFree(t);
+}
+
+static void removeAllTiles(uiprivTileCache *tc)
+{
+	while (tc->lru.head != NULL)
+		removeTile(tc, (struct tile *) (tc->lru.head->data));
+}
+
+static void invalidateTile(uiprivTileCache *tc, struct tile *t)
+{
+	if (!tc->async) {
+		removeTile(tc, t);
+		return;
+	}
+	t->stale = TRUE;
+	t->generation = ++tc->generation;
+}
+
+void uiprivTileCacheInvalidateAll(uiprivTileCache *tc)
+{
+	GList *l, *next;
+
+	for (l = tc->lru.head; l != NULL; l = next) {
+		next = l->next;
+		invalidateTile(tc, (struct tile *) (l->data));
+	}
+}
+
+void uiprivFreeTileCache(uiprivTileCache *tc)
+{
+	removeAllTiles(tc);
+	g_mutex_lock(&(tc->lock));
+	g_atomic_int_set(&(tc->dead), TRUE);
+	while (tc->running != 0)
+		g_cond_wait(&(tc->idle), &(tc->lock));
+	g_mutex_unlock(&(tc->lock));
+	unrefTileCache(tc);
+}
+
+void uiprivTileCacheInvalidate(uiprivTileCache *tc, double x, double y, double width, double height)
+{
+	GList *l, *next;
+	struct tile *t;
+	double tx, ty;
+
+	// the cache is bounded by its budget, so walking all of it is cheap and works no matter how big the rectangle is
+	for (l = tc->lru.head; l != NULL; l = next) {
+		next = l->next;
+		t = (struct tile *) (l->data);
+		tx = t->x * (double) (tc->tileSize);
+		ty = t->y * (double) (tc->tileSize);
+		if (tx >= x + width || tx + tc->tileSize <= x)
+			continue;
+		if (ty >= y + height || ty + tc->tileSize <= y)
+			continue;
+		invalidateTile(tc, t);
+	}
+}
+
+// this runs on either thread, so it must not touch anything but its arguments
+static void renderTileSurface(uiprivTileCache *tc, cairo_surface_t *surface, int x, int y, GtkStyleContext *style)
+{
+	cairo_t *cr;
+	double tx, ty;
+
+	tx = x * (double) (tc->tileSize);
+	ty = y * (double) (tc->tileSize);
+	cr = cairo_create(surface);
+	cairo_translate(cr, -tx, -ty);
+	cairo_rectangle(cr, tx, ty, tc->tileSize, tc->tileSize);
+	cairo_clip(cr);
+	(*(tc->render))(cr, tx, ty, tc->tileSize, tc->tileSize, style, tc->renderData);
+	cairo_destroy(cr);
+	cairo_surface_flush(surface);
+}
+
+static void setTileSurface(uiprivTileCache *tc, struct tile *t, cairo_surface_t *surface)
+{
+	tc->used -= t->size;
+	if (t->surface != NULL)
+		cairo_surface_destroy(t->surface);
+	t->surface = surface;
+	t->size = (size_t) cairo_image_surface_get_stride(surface) * (size_t) cairo_image_surface_get_height(surface);
+	tc->used += t->size;
+}
+
+static void freeJob(struct tileJob *j)
+{
+	if (j->surface != NULL)
+		cairo_surface_destroy(j->surface);
+	unrefTileCache(j->tc);
+	uiprivFree(j);
+}
+
+static void finishJob(struct tileJob *j)
+{
+	uiprivTileCache *tc = j->tc;
+	struct tile key;
+	struct tile *t;
+
+	if (tc->dead || j->surface == NULL || j->scale != tc->scale) {
+		freeJob(j);
+		return;
+	}
+	key.x = j->x;
+	key.y = j->y;
+	t = (struct tile *) g_hash_table_lookup(tc->tiles, &key);
+	if (t == NULL || !t->pending || j->generation != t->queued) {
+		// evicted while it was being rendered; if the tile was created again since, its own job is still running
+		freeJob(j);
+		return;
+	}
+	t->pending = FALSE;
+	setTileSurface(tc, t, j->surface);
+	j->surface = NULL;
+	// a result rendered before the latest invalidation is still newer than what we had, so show it, but render again
+	t->stale = j->generation != t->generation;
+	gtk_widget_queue_draw_area(tc->widget,
+		t->x * tc->tileSize, t->y * tc->tileSize,
+		tc->tileSize, tc->tileSize);
+	freeJob(j);
+}
+
+static gboolean finishJobs(gpointer data)
+{
+	struct tileJob *j;
+
+	G_LOCK(doneSource);
+	doneSource = 0;
+	G_UNLOCK(doneSource);
+	while ((j = (struct tileJob *) g_async_queue_try_pop(done)) != NULL)
+		finishJob(j);
+	return G_SOURCE_REMOVE;
+}
+
+static void runJob(gpointer data, gpointer userData)
+{
+	struct tileJob *j = (struct tileJob *) data;
+	uiprivTileCache *tc = j->tc;
+	gboolean dead;
+
+	g_mutex_lock(&(tc->lock));
+	dead = g_atomic_int_get(&(tc->dead));
+	if (!dead)
+		tc->running++;
+	g_mutex_unlock(&(tc->lock));
+	if (!dead) {
+		j->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+			tc->tileSize * j->scale, tc->tileSize * j->scale);
+		cairo_surface_set_device_scale(j->surface, j->scale, j->scale);
+		// GtkStyleContext is not thread-safe, and drawing doesn't need it
+		renderTileSurface(tc, j->surface, j->x, j->y, NULL);
+		g_mutex_lock(&(tc->lock));
+		tc->running--;
+		if (tc->running == 0)
+			g_cond_broadcast(&(tc->idle));
+		g_mutex_unlock(&(tc->lock));
+	}
+	g_async_queue_push(done, j);
+	// batch finished tiles into one main loop dispatch; this runs just before GTK+ redraws
+	G_LOCK(doneSource);
+	if (doneSource == 0)
+		doneSource = g_idle_add_full(G_PRIORITY_HIGH_IDLE, finishJobs, NULL, NULL);
+	G_UNLOCK(doneSource);
+}
+
+static void queueTile(uiprivTileCache *tc, struct tile *t)
+{
+	struct tileJob *j;
+
+	if (pool == NULL) {
+		done = g_async_queue_new();
+		pool = g_thread_pool_new(runJob, NULL, g_get_num_processors(), FALSE, NULL);
+	}
+	j = uiprivNew(struct tileJob);
+	j->tc = tc;
+	tc->refcount++;
+	j->x = t->x;
+	j->y = t->y;
+	j->scale = tc->scale;
+	j->generation = t->generation;
+	t->queued = t->generation;
+	t->pending = TRUE;
+	g_thread_pool_push(pool, j, NULL);
+}
+
+void uiprivTileCacheSetAsync(uiprivTileCache *tc, gboolean async)
+{
+	// stale tiles only make sense in asynchronous mode
+	if (tc->async && !async)
+		removeAllTiles(tc);
+	tc->async = async;
+}
+
+void uiprivUninitTiles(void)
+{
+	struct tileJob *j;
+
+	if (pool == NULL)
+		return;
+	// every cache is dead by now, so the remaining jobs return without rendering
+	g_thread_pool_free(pool, FALSE, TRUE);
+	pool = NULL;
+	if (doneSource != 0) {
+		g_source_remove(doneSource);
+		doneSource = 0;
+	}
+	while ((j = (struct tileJob *) g_async_queue_try_pop(done)) != NULL)
+		freeJob(j);
+	g_async_queue_unref(done);
+	done = NULL;
+}
+
+static struct tile *newTile(uiprivTileCache *tc, int x, int y)
+{
+	struct tile *t;
+
+	t = uiprivNew(struct tile);
+	t->x = x;
+	t->y = y;
+	t->generation = ++tc->generation;
+	t->link.data = t;
+	if (!tc->async) {
+		// this gives us an image surface with the window's device scale already set, so we can draw in drawing space
+		setTileSurface(tc, t, gdk_window_create_similar_image_surface(gtk_widget_get_window(tc->widget),
+			CAIRO_FORMAT_ARGB32, tc->tileSize, tc->tileSize, tc->scale));
+		renderTileSurface(tc, t->surface, x, y, gtk_widget_get_style_context(tc->widget));
+	}
+	g_hash_table_add(tc->tiles, t);
+	return t;
+}
+
+static struct tile *getTile(uiprivTileCache *tc, int x, int y)
+{
+	struct tile key;
+	struct tile *t;
+
+	key.x = x;
+	key.y = y;
+	t = (struct tile *) g_hash_table_lookup(tc->tiles, &key);
+	if (t != NULL)
+		g_queue_unlink(&(tc->lru), &(t->link));
+	else
+		t = newTile(tc, x, y);
+	g_queue_push_head_link(&(tc->lru), &(t->link));
+	if (tc->async && (t->surface == NULL || t->stale) && !t->pending)
+		queueTile(tc, t);
+	return t;
+}
+
+void uiprivTileCacheDraw(uiprivTileCache *tc, cairo_t *cr)
+{
+	double clipX0, clipY0, clipX1, clipY1;
+	int x0, y0, x1, y1;
+	int x, y;
+	struct tile *t;
+	size_t visible;
+
+	// a window moved to a monitor with a different scale factor needs all new tiles
+	if (gtk_widget_get_scale_factor(tc->widget) != tc->scale) {
+		removeAllTiles(tc);
+		tc->scale = gtk_widget_get_scale_factor(tc->widget);
+	}
+
+	cairo_clip_extents(cr, &clipX0, &clipY0, &clipX1, &clipY1);
+	x0 = (int) floor(clipX0 / tc->tileSize);
+	y0 = (int) floor(clipY0 / tc->tileSize);
+	x1 = (int) ceil(clipX1 / tc->tileSize);
+	y1 = (int) ceil(clipY1 / tc->tileSize);
+
+	visible = 0;
+	for (y = y0; y < y1; y++)
+		for (x = x0; x < x1; x++) {
+			t = getTile(tc, x, y);
+			visible++;
+			// asynchronous tiles that have never been rendered are left blank until they arrive
+			if (t->surface == NULL)
+				continue;
+			cairo_set_source_surface(cr, t->surface,
+				x * (double) (tc->tileSize), y * (double) (tc->tileSize));
+			cairo_rectangle(cr,
+				x * (double) (tc->tileSize), y * (double) (tc->tileSize),
+				tc->tileSize, tc->tileSize);
+			cairo_fill(cr);
+		}
+
+	// evict only after compositing, and never the tiles we just drew, so a budget smaller than the viewport degrades to plain redrawing instead of thrashing mid-frame
+	while (tc->used > tc->budget && (size_t) (tc->lru.length) > visible)
+		removeTile(tc, (struct tile *) (tc->lru.tail->data));
+}
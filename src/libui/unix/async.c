@@ -0,0 +1,293 @@
+// 19 october 2026
+#include "uipriv_unix.h"
+
+// uiRunAsync() runs tasks on a pool of worker threads that steal work from each other
+// every worker has its own deque of tasks; it takes the newest task from its own deque, and when that's empty it steals the oldest task from another one
+// tasks started by a task go to the deque of the worker running it, so work that splits itself up stays with one thread until others run out of work
+// tasks started from any other thread are dealt out to the workers in turn
+// when a task is done, its done function is sent to the main thread with uiQueueMain(), which batches them
+#define maxWorkers 64
+
+struct uiAsyncTask {
+	void (*work)(uiAsyncTask *, void *);
+	void (*done)(uiAsyncTask *, int, void *);
+	void *data;
+	gint canceled;
+	// every task is in the live list from uiRunAsync() until its done function returns, so uiUninit() can find them
+	uiAsyncTask *prev;
+	uiAsyncTask *next;
+};
+
+struct worker {
+	GMutex lock;
+	GQueue tasks;		// oldest first
+	GThread *thread;
+	int index;
+	gboolean exited;		// set by the thread itself on the way out; guarded by sleepLock
+};
+
+static struct worker workers[maxWorkers];
+static GPrivate currentWorker;
+
+// sleepLock guards starting and stopping workers, and the sleeping; the deques have their own locks
+static GMutex sleepLock;
+static GCond wake;
+static gint nSleeping = 0;
+static gint queued = 0;		// tasks in all the deques; only a hint, and briefly negative at times
+static gint started = 0;
+static gboolean quitting = FALSE;
+static int requested = 0;		// what uiAsyncSetWorkers() asked for; 0 for one per processor
+static gint nWorkers = 0;		// workers 0 to nWorkers - 1 take new tasks
+static gint nSlots = 0;		// deques 0 to nSlots - 1 may have tasks to steal
+static gint nextWorker = 0;
+
+G_LOCK_DEFINE_STATIC(live);
+static uiAsyncTask *live = NULL;
+
+static int workersWanted(void)
+{
+	int n;
+
+	n = requested;
+	if (n <= 0)
+		n = (int) g_get_num_processors();
+	if (n < 1)
+		n = 1;
+	if (n > maxWorkers)
+		n = maxWorkers;
+	return n;
+}
+
+static uiAsyncTask *take(struct worker *w)
+{
+	uiAsyncTask *t;
+	struct worker *victim;
+	int i, n;
+
+	g_mutex_lock(&(w->lock));
+	t = (uiAsyncTask *) g_queue_pop_tail(&(w->tasks));
+	g_mutex_unlock(&(w->lock));
+	if (t == NULL) {
+		n = g_atomic_int_get(&nSlots);
+		for (i = 1; i < n && t == NULL; i++) {
+			victim = &(workers[(w->index + i) % n]);
+			g_mutex_lock(&(victim->lock));
+			t = (uiAsyncTask *) g_queue_pop_head(&(victim->tasks));
+			g_mutex_unlock(&(victim->lock));
+		}
+	}
+	if (t != NULL)
+		g_atomic_int_add(&queued, -1);
+	return t;
+}
+
+static void deliver(void *data)
+{
+	uiAsyncTask *t = (uiAsyncTask *) data;
+
+	G_LOCK(live);
+	if (t->prev != NULL)
+		t->prev->next = t->next;
+	else
+		live = t->next;
+	if (t->next != NULL)
+		t->next->prev = t->prev;
+	G_UNLOCK(live);
+	if (t->done != NULL)
+		(*(t->done))(t, g_atomic_int_get(&(t->canceled)), t->data);
+	g_free(t);
+}
+
+static void run(uiAsyncTask *t)
+{
+	if (!g_atomic_int_get(&(t->canceled)))
+		(*(t->work))(t, t->data);
+	uiQueueMain(deliver, t);
+}
+
+// with sleepLock held
+static gboolean shouldExit(struct worker *w)
+{
+	gboolean empty;
+
+	if (quitting)
+		return TRUE;
+	if (w->index < g_atomic_int_get(&nWorkers))
+		return FALSE;
+	// a retired worker stays until its own deque is empty; the others can steal from it in the meantime
+	g_mutex_lock(&(w->lock));
+	empty = g_queue_is_empty(&(w->tasks));
+	g_mutex_unlock(&(w->lock));
+	return empty;
+}
+
+static gpointer workerMain(gpointer data)
+{
+	struct worker *w = (struct worker *) data;
+	uiAsyncTask *t;
+
+	g_private_set(&currentWorker, w);
+	for (;;) {
+		t = take(w);
+		if (t != NULL) {
+			run(t);
+			continue;
+		}
+		g_mutex_lock(&sleepLock);
+		if (shouldExit(w)) {
+			w->exited = TRUE;
+			// whoever woke us might have meant for someone else to take a task
+			if (g_atomic_int_get(&queued) > 0)
+				g_cond_signal(&wake);
+			g_mutex_unlock(&sleepLock);
+			return NULL;
+		}
+		// nSleeping has to go up before queued is read; see wakeOne()
+		g_atomic_int_inc(&nSleeping);
+		while (g_atomic_int_get(&queued) <= 0 && !shouldExit(w))
+			g_cond_wait(&wake, &sleepLock);
+		g_atomic_int_add(&nSleeping, -1);
+		g_mutex_unlock(&sleepLock);
+	}
+}
+
+// a worker going to sleep counts itself in nSleeping and then looks at queued, both with the lock held; we change queued and then look at nSleeping
+// so either it sees the new task, or we see it and take the lock to wake it, which can't happen until it's waiting
+// most of the time every worker is busy, and adding a task doesn't touch the lock at all
+static void wakeOne(void)
+{
+	if (g_atomic_int_get(&nSleeping) == 0)
+		return;
+	g_mutex_lock(&sleepLock);
+	g_cond_signal(&wake);
+	g_mutex_unlock(&sleepLock);
+}
+
+// with sleepLock held
+static void startWorkers(void)
+{
+	struct worker *w;
+	int i, n;
+
+	n = workersWanted();
+	for (i = 0; i < n; i++) {
+		w = &(workers[i]);
+		w->index = i;
+		// a worker retired by an earlier uiAsyncSetWorkers(); bring it back
+		if (w->thread != NULL && w->exited) {
+			g_thread_join(w->thread);
+			w->thread = NULL;
+		}
+		if (w->thread == NULL) {
+			w->exited = FALSE;
+			w->thread = g_thread_new("uiAsync", workerMain, w);
+		}
+	}
+	if (n > g_atomic_int_get(&nSlots))
+		g_atomic_int_set(&nSlots, n);
+	g_atomic_int_set(&nWorkers, n);
+	// retired workers with nothing left to do leave now
+	g_cond_broadcast(&wake);
+}
+
+uiAsyncTask *uiRunAsync(void (*work)(uiAsyncTask *task, void *data), void (*done)(uiAsyncTask *task, int canceled, void *data), void *data)
+{
+	uiAsyncTask *t;
+	struct worker *w;
+	int64_t start;
+
+	if (!g_atomic_int_get(&started)) {
+		g_mutex_lock(&sleepLock);
+		if (!g_atomic_int_get(&started)) {
+			start = uiMainTime();
+			startWorkers();
+			uiprivCountDeferredInit(start);
+			g_atomic_int_set(&started, 1);
+		}
+		g_mutex_unlock(&sleepLock);
+	}
+
+	// g_new0() because this can be called from any thread; see uiQueueMain()
+	t = g_new0(uiAsyncTask, 1);
+	t->work = work;
+	t->done = done;
+	t->data = data;
+	G_LOCK(live);
+	t->next = live;
+	if (live != NULL)
+		live->prev = t;
+	live = t;
+	G_UNLOCK(live);
+
+	w = (struct worker *) g_private_get(&currentWorker);
+	if (w == NULL)
+		w = &(workers[(guint) g_atomic_int_add(&nextWorker, 1) % (guint) g_atomic_int_get(&nWorkers)]);
+	g_mutex_lock(&(w->lock));
+	g_queue_push_tail(&(w->tasks), t);
+	g_mutex_unlock(&(w->lock));
+	g_atomic_int_inc(&queued);
+	wakeOne();
+	return t;
+}
+
+void uiAsyncCancel(uiAsyncTask *t)
+{
+	g_atomic_int_set(&(t->canceled), 1);
+}
+
+int uiAsyncCanceled(uiAsyncTask *t)
+{
+	return g_atomic_int_get(&(t->canceled));
+}
+
+void uiAsyncSetWorkers(int n)
+{
+	if (n < 0)
+		n = 0;
+	g_mutex_lock(&sleepLock);
+	requested = n;
+	if (g_atomic_int_get(&started))
+		startWorkers();
+	g_mutex_unlock(&sleepLock);
+}
+
+// tasks still running when uiUninit() runs are canceled and waited for; their done functions, like those of tasks that never ran, are dropped
+void uiprivUninitAsync(void)
+{
+	uiAsyncTask *t;
+	int i;
+
+	if (!g_atomic_int_get(&started))
+		return;
+	G_LOCK(live);
+	for (t = live; t != NULL; t = t->next)
+		g_atomic_int_set(&(t->canceled), 1);
+	G_UNLOCK(live);
+
+	g_mutex_lock(&sleepLock);
+	quitting = TRUE;
+	g_cond_broadcast(&wake);
+	g_mutex_unlock(&sleepLock);
+	for (i = 0; i < maxWorkers; i++) {
+		if (workers[i].thread != NULL)
+			g_thread_join(workers[i].thread);
+		workers[i].thread = NULL;
+		workers[i].exited = FALSE;
+		g_queue_clear(&(workers[i].tasks));
+	}
+
+	// the calls of deliver() still queued are dropped by uiUninit() right after this, so nothing looks at these anymore
+	G_LOCK(live);
+	while (live != NULL) {
+		t = live;
+		live = t->next;
+		g_free(t);
+	}
+	G_UNLOCK(live);
+
+	quitting = FALSE;
+	g_atomic_int_set(&queued, 0);
+	g_atomic_int_set(&nWorkers, 0);
+	g_atomic_int_set(&nSlots, 0);
+	g_atomic_int_set(&started, 0);
+}
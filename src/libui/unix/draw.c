@@ -1,6 +1,7 @@
 // 6 september 2015
 #include "uipriv_unix.h"
 #include "draw.h"
+#include <time.h>
 
 uiDrawContext *uiprivNewContext(cairo_t *cr, GtkStyleContext *style)
 {
@@ -9,9 +10,24 @@ uiDrawContext *uiprivNewContext(cairo_t *cr, GtkStyleContext *style)
 	c = uiprivNew(uiDrawContext);
 	c->cr = cr;
 	c->style = style;
+	c->stats = NULL;
 	return c;
 }
 
+uint64_t uiprivDrawStatsNow(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t) (ts.tv_sec)) * 1000000000 + (uint64_t) (ts.tv_nsec);
+}
+
+void uiprivDrawStatsEnd(uiDrawContext *c, uint64_t start)
+{
+	if (c->stats != NULL)
+		c->stats->DrawingTime += uiprivDrawStatsNow() - start;
+}
+
 void uiprivFreeContext(uiDrawContext *c)
 {
 	// free neither cr nor style; we own neither
@@ -55,49 +71,208 @@ static cairo_pattern_t *mkbrush(uiDrawBrush *b)
 	return pat;
 }
 
-void uiDrawStroke(uiDrawContext *c, uiDrawPath *path, uiDrawBrush *b, uiDrawStrokeParams *p)
-{
+// gradient patterns are expensive to build (every stop has to be added again) and charts tend to draw many shapes with the same gradient, so keep the most recently used ones around
+// uiDrawBrush is filled in by the caller and has no identity of its own, so the cache is keyed on the brush contents
+// the cache is tiny, so a move-to-front array is all the LRU we need
+#define nBrushCache 16
+
+struct brushCacheEntry {
+	guint hash;
+	uiDrawBrushType type;
+	double params[5];
+	uiDrawBrushGradientStop *stops;
+	size_t nStops;
 	cairo_pattern_t *pat;
+};
+
+// asynchronous area tiles draw from worker threads, so the cache is locked
+G_LOCK_DEFINE_STATIC(brushCache);
+static struct brushCacheEntry brushCache[nBrushCache];
+static int nBrushCacheEntries = 0;
+
+// FNV-1a over the bytes of each double; -0.0 and 0.0 hash differently, which only costs us a cache miss
+static guint hashDouble(guint h, double d)
+{
+	const guint8 *p = (const guint8 *) (&d);
+	size_t i;
+
+	for (i = 0; i < sizeof (double); i++)
+		h = (h ^ p[i]) * 16777619u;
+	return h;
+}
+
+static void brushParams(uiDrawBrush *b, double params[5])
+{
+	params[0] = b->X0;
+	params[1] = b->Y0;
+	params[2] = b->X1;
+	params[3] = b->Y1;
+	params[4] = b->OuterRadius;
+	if (b->Type != uiDrawBrushTypeRadialGradient)
+		params[4] = 0;
+}
+
+static guint hashBrush(uiDrawBrush *b, double params[5])
+{
+	guint h;
+	size_t i;
+
+	h = 2166136261u;
+	h = (h ^ (guint) (b->Type)) * 16777619u;
+	for (i = 0; i < 5; i++)
+		h = hashDouble(h, params[i]);
+	for (i = 0; i < b->NumStops; i++) {
+		h = hashDouble(h, b->Stops[i].Pos);
+		h = hashDouble(h, b->Stops[i].R);
+		h = hashDouble(h, b->Stops[i].G);
+		h = hashDouble(h, b->Stops[i].B);
+		h = hashDouble(h, b->Stops[i].A);
+	}
+	return h;
+}
+
+static gboolean brushCacheEntryMatches(struct brushCacheEntry *e, guint hash, uiDrawBrush *b, double params[5])
+{
+	if (e->hash != hash || e->type != b->Type || e->nStops != b->NumStops)
+		return FALSE;
+	if (memcmp(e->params, params, 5 * sizeof (double)) != 0)
+		return FALSE;
+	if (e->nStops == 0)
+		return TRUE;
+	return memcmp(e->stops, b->Stops, e->nStops * sizeof (uiDrawBrushGradientStop)) == 0;
+}
+
+static void freeBrushCacheEntry(struct brushCacheEntry *e)
+{
+	cairo_pattern_destroy(e->pat);
+	if (e->stops != NULL)
+		uiprivFree(e->stops);
+}
+
+static cairo_pattern_t *cachedBrush(uiDrawBrush *b, gboolean *created)
+{
+	struct brushCacheEntry e;
+	double params[5];
+	guint hash;
+	int i;
 
-	uiprivRunPath(path, c->cr);
-	pat = mkbrush(b);
-	cairo_set_source(c->cr, pat);
+	brushParams(b, params);
+	hash = hashBrush(b, params);
+	for (i = 0; i < nBrushCacheEntries; i++)
+		if (brushCacheEntryMatches(&(brushCache[i]), hash, b, params)) {
+			e = brushCache[i];
+			memmove(&(brushCache[1]), &(brushCache[0]), i * sizeof (struct brushCacheEntry));
+			brushCache[0] = e;
+			*created = FALSE;
+			return e.pat;
+		}
+
+	if (nBrushCacheEntries == nBrushCache) {
+		nBrushCacheEntries--;
+		freeBrushCacheEntry(&(brushCache[nBrushCacheEntries]));
+	}
+	e.hash = hash;
+	e.type = b->Type;
+	memcpy(e.params, params, 5 * sizeof (double));
+	e.nStops = b->NumStops;
+	e.stops = NULL;
+	if (e.nStops != 0) {
+		e.stops = (uiDrawBrushGradientStop *) uiprivAlloc(e.nStops * sizeof (uiDrawBrushGradientStop), "uiDrawBrushGradientStop[]");
+		memcpy(e.stops, b->Stops, e.nStops * sizeof (uiDrawBrushGradientStop));
+	}
+	e.pat = mkbrush(b);
+	memmove(&(brushCache[1]), &(brushCache[0]), nBrushCacheEntries * sizeof (struct brushCacheEntry));
+	brushCache[0] = e;
+	nBrushCacheEntries++;
+	*created = TRUE;
+	return e.pat;
+}
+
+// solid colors don't need a pattern object of our own; cairo keeps its own solid pattern for cairo_set_source_rgba()
+// returns whether a pattern had to be created, for uiAreaDrawStats
+gboolean uiprivSetSource(cairo_t *cr, uiDrawBrush *b)
+{
+	gboolean created;
+
+	if (b->Type == uiDrawBrushTypeSolid) {
+		cairo_set_source_rgba(cr, b->R, b->G, b->B, b->A);
+		return FALSE;
+	}
+	// cairo_set_source() takes its own reference, so the cache can keep ours
+	// it has to take it before another thread can evict the pattern
+	G_LOCK(brushCache);
+	cairo_set_source(cr, cachedBrush(b, &created));
+	G_UNLOCK(brushCache);
+	return created;
+}
+
+void uiprivUninitDraw(void)
+{
+	int i;
+
+	for (i = 0; i < nBrushCacheEntries; i++)
+		freeBrushCacheEntry(&(brushCache[i]));
+	nBrushCacheEntries = 0;
+	uiprivUninitDrawPath();
+}
+
+void uiprivSetStrokeParams(cairo_t *cr, uiDrawStrokeParams *p)
+{
 	switch (p->Cap) {
 	case uiDrawLineCapFlat:
-		cairo_set_line_cap(c->cr, CAIRO_LINE_CAP_BUTT);
+		cairo_set_line_cap(cr, CAIRO_LINE_CAP_BUTT);
 		break;
 	case uiDrawLineCapRound:
-		cairo_set_line_cap(c->cr, CAIRO_LINE_CAP_ROUND);
+		cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
 		break;
 	case uiDrawLineCapSquare:
-		cairo_set_line_cap(c->cr, CAIRO_LINE_CAP_SQUARE);
+		cairo_set_line_cap(cr, CAIRO_LINE_CAP_SQUARE);
 		break;
 	}
 	switch (p->Join) {
 	case uiDrawLineJoinMiter:
-		cairo_set_line_join(c->cr, CAIRO_LINE_JOIN_MITER);
-		cairo_set_miter_limit(c->cr, p->MiterLimit);
+		cairo_set_line_join(cr, CAIRO_LINE_JOIN_MITER);
+		cairo_set_miter_limit(cr, p->MiterLimit);
 		break;
 	case uiDrawLineJoinRound:
-		cairo_set_line_join(c->cr, CAIRO_LINE_JOIN_ROUND);
+		cairo_set_line_join(cr, CAIRO_LINE_JOIN_ROUND);
 		break;
 	case uiDrawLineJoinBevel:
-		cairo_set_line_join(c->cr, CAIRO_LINE_JOIN_BEVEL);
+		cairo_set_line_join(cr, CAIRO_LINE_JOIN_BEVEL);
 		break;
 	}
-	cairo_set_line_width(c->cr, p->Thickness);
-	cairo_set_dash(c->cr, p->Dashes, p->NumDashes, p->DashPhase);
+	cairo_set_line_width(cr, p->Thickness);
+	cairo_set_dash(cr, p->Dashes, p->NumDashes, p->DashPhase);
+}
+
+void uiDrawStroke(uiDrawContext *c, uiDrawPath *path, uiDrawBrush *b, uiDrawStrokeParams *p)
+{
+	uint64_t start;
+	size_t n;
+	gboolean created;
+
+	start = uiprivDrawStatsBegin(c);
+	n = uiprivRunPath(path, c->cr);
+	created = uiprivSetSource(c->cr, b);
+	uiprivSetStrokeParams(c->cr, p);
 	cairo_stroke(c->cr);
-	cairo_pattern_destroy(pat);
+	if (c->stats != NULL) {
+		c->stats->Strokes++;
+		c->stats->PathSegments += n;
+		c->stats->Patterns += created;
+		uiprivDrawStatsEnd(c, start);
+	}
 }
 
 void uiDrawFill(uiDrawContext *c, uiDrawPath *path, uiDrawBrush *b)
 {
-	cairo_pattern_t *pat;
+	uint64_t start;
+	size_t n;
+	gboolean created;
 
-	uiprivRunPath(path, c->cr);
-	pat = mkbrush(b);
-	cairo_set_source(c->cr, pat);
+	start = uiprivDrawStatsBegin(c);
+	n = uiprivRunPath(path, c->cr);
+	created = uiprivSetSource(c->cr, b);
 	switch (uiprivPathFillMode(path)) {
 	case uiDrawFillModeWinding:
 		cairo_set_fill_rule(c->cr, CAIRO_FILL_RULE_WINDING);
@@ -107,7 +282,12 @@ void uiDrawFill(uiDrawContext *c, uiDrawPath *path, uiDrawBrush *b)
 		break;
 	}
 	cairo_fill(c->cr);
-	cairo_pattern_destroy(pat);
+	if (c->stats != NULL) {
+		c->stats->Fills++;
+		c->stats->PathSegments += n;
+		c->stats->Patterns += created;
+		uiprivDrawStatsEnd(c, start);
+	}
 }
 
 void uiDrawTransform(uiDrawContext *c, uiDrawMatrix *m)
@@ -120,7 +300,11 @@ void uiDrawTransform(uiDrawContext *c, uiDrawMatrix *m)
 
 void uiDrawClip(uiDrawContext *c, uiDrawPath *path)
 {
-	uiprivRunPath(path, c->cr);
+	uint64_t start;
+	size_t n;
+
+	start = uiprivDrawStatsBegin(c);
+	n = uiprivRunPath(path, c->cr);
 	switch (uiprivPathFillMode(path)) {
 	case uiDrawFillModeWinding:
 		cairo_set_fill_rule(c->cr, CAIRO_FILL_RULE_WINDING);
@@ -130,6 +314,11 @@ void uiDrawClip(uiDrawContext *c, uiDrawPath *path)
 		break;
 	}
 	cairo_clip(c->cr);
+	if (c->stats != NULL) {
+		c->stats->Clips++;
+		c->stats->PathSegments += n;
+		uiprivDrawStatsEnd(c, start);
+	}
 }
 
 void uiDrawSave(uiDrawContext *c)
@@ -4,11 +4,18 @@
 struct uiDrawContext {
 	cairo_t *cr;
 	GtkStyleContext *style;
+	uiAreaDrawStats *stats;		// NULL unless the uiArea is counting; see uiAreaSetDrawStatistics()
 };
+extern gboolean uiprivSetSource(cairo_t *cr, uiDrawBrush *b);
+extern uint64_t uiprivDrawStatsNow(void);
+#define uiprivDrawStatsBegin(c) ((c)->stats != NULL ? uiprivDrawStatsNow() : 0)
+extern void uiprivDrawStatsEnd(uiDrawContext *c, uint64_t start);
+extern void uiprivSetStrokeParams(cairo_t *cr, uiDrawStrokeParams *p);
 
 // drawpath.c
-extern void uiprivRunPath(uiDrawPath *p, cairo_t *cr);
+extern size_t uiprivRunPath(uiDrawPath *p, cairo_t *cr);
 extern uiDrawFillMode uiprivPathFillMode(uiDrawPath *path);
+extern void uiprivUninitDrawPath(void);
 
 // drawmatrix.c
 extern void uiprivM2C(uiDrawMatrix *m, cairo_matrix_t *c);
@@ -0,0 +1,145 @@
+// 19 october 2026
+#include "uipriv_unix.h"
+#include "draw.h"
+
+// all of these build one cairo path per run of same-colored items and fill or stroke it once
+// there is no uiDrawPath and no per-item allocation; cairo is fed the geometry directly
+
+enum shape {
+	shapeRectangle,
+	shapeCircle,
+	shapeLine,
+};
+
+static void addItem(cairo_t *cr, enum shape shape, const double *item, double radius)
+{
+	double x, y, width, height;
+
+	switch (shape) {
+	case shapeRectangle:
+		// all rectangles of a run share one path filled with the nonzero winding rule, so they must all wind the same way; a flipped one would cancel out where it overlaps the others
+		x = item[0];
+		y = item[1];
+		width = item[2];
+		height = item[3];
+		if (width < 0) {
+			x += width;
+			width = -width;
+		}
+		if (height < 0) {
+			y += height;
+			height = -height;
+		}
+		cairo_rectangle(cr, x, y, width, height);
+		break;
+	case shapeCircle:
+		cairo_new_sub_path(cr);
+		cairo_arc(cr, item[0], item[1], radius, 0, 2 * uiPi);
+		break;
+	case shapeLine:
+		cairo_move_to(cr, item[0], item[1]);
+		cairo_line_to(cr, item[2], item[3]);
+		break;
+	}
+}
+
+static gboolean sameColor(const double *a, const double *b)
+{
+	return a[0] == b[0] && a[1] == b[1] && a[2] == b[2] && a[3] == b[3];
+}
+
+static void finish(uiDrawContext *c, gboolean stroke)
+{
+	if (stroke)
+		cairo_stroke(c->cr);
+	else
+		cairo_fill(c->cr);
+	if (c->stats == NULL)
+		return;
+	if (stroke)
+		c->stats->Strokes++;
+	else
+		c->stats->Fills++;
+}
+
+static void drawItems(uiDrawContext *c, const double *items, size_t stride, size_t n, double radius, enum shape shape, uiDrawBrush *b, const double *colors, gboolean stroke)
+{
+	cairo_t *cr = c->cr;
+	size_t i, run;
+	uint64_t start;
+	gboolean created;
+
+	if (n == 0)
+		return;
+	start = uiprivDrawStatsBegin(c);
+	if (c->stats != NULL)
+		c->stats->PathSegments += n;
+	cairo_new_path(cr);
+	if (colors == NULL) {
+		created = uiprivSetSource(cr, b);
+		for (i = 0; i < n; i++)
+			addItem(cr, shape, items + i * stride, radius);
+		finish(c, stroke);
+		if (c->stats != NULL) {
+			c->stats->Patterns += created;
+			uiprivDrawStatsEnd(c, start);
+		}
+		return;
+	}
+
+	run = 0;
+	for (i = 0; i < n; i++) {
+		if (i != run && !sameColor(colors + i * 4, colors + run * 4)) {
+			cairo_set_source_rgba(cr, colors[run * 4], colors[run * 4 + 1], colors[run * 4 + 2], colors[run * 4 + 3]);
+			// this also clears the path for the next run
+			finish(c, stroke);
+			run = i;
+		}
+		addItem(cr, shape, items + i * stride, radius);
+	}
+	cairo_set_source_rgba(cr, colors[run * 4], colors[run * 4 + 1], colors[run * 4 + 2], colors[run * 4 + 3]);
+	finish(c, stroke);
+	uiprivDrawStatsEnd(c, start);
+}
+
+void uiDrawFillRectangles(uiDrawContext *c, const double *rects, size_t n, uiDrawBrush *b, const double *colors)
+{
+	cairo_set_fill_rule(c->cr, CAIRO_FILL_RULE_WINDING);
+	drawItems(c, rects, 4, n, 0, shapeRectangle, b, colors, FALSE);
+}
+
+void uiDrawFillCircles(uiDrawContext *c, const double *centers, size_t n, double radius, uiDrawBrush *b, const double *colors)
+{
+	cairo_set_fill_rule(c->cr, CAIRO_FILL_RULE_WINDING);
+	drawItems(c, centers, 2, n, radius, shapeCircle, b, colors, FALSE);
+}
+
+void uiDrawStrokeLines(uiDrawContext *c, const double *lines, size_t n, uiDrawBrush *b, uiDrawStrokeParams *p, const double *colors)
+{
+	uiprivSetStrokeParams(c->cr, p);
+	drawItems(c, lines, 4, n, 0, shapeLine, b, colors, TRUE);
+}
+
+void uiDrawStrokePolyline(uiDrawContext *c, const double *points, size_t n, uiDrawBrush *b, uiDrawStrokeParams *p)
+{
+	size_t i;
+	uint64_t start;
+	gboolean created;
+
+	if (n < 2)
+		return;
+	start = uiprivDrawStatsBegin(c);
+	cairo_new_path(c->cr);
+	cairo_move_to(c->cr, points[0], points[1]);
+	for (i = 1; i < n; i++)
+		cairo_line_to(c->cr, points[i * 2], points[i * 2 + 1]);
+	created = uiprivSetSource(c->cr, b);
+	uiprivSetStrokeParams(c->cr, p);
+	cairo_stroke(c->cr);
+	if (c->stats != NULL) {
+		c->stats->Strokes++;
+		c->stats->PathSegments += n - 1;
+		c->stats->Patterns += created;
+		uiprivDrawStatsEnd(c, start);
+	}
+}
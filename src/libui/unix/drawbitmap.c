@@ -0,0 +1,107 @@
+// 19 october 2026
+#include "uipriv_unix.h"
+#include "draw.h"
+
+// CAIRO_FORMAT_ARGB32 is exactly the documented uiDrawBitmap pixel format, so cairo can read the caller's memory directly
+
+struct uiDrawBitmap {
+	cairo_surface_t *surface;
+	int width;
+	int height;
+};
+
+static const cairo_filter_t filters[] = {
+	[uiDrawBitmapFilterNearest] = CAIRO_FILTER_NEAREST,
+	[uiDrawBitmapFilterBilinear] = CAIRO_FILTER_BILINEAR,
+};
+
+uiDrawBitmap *uiDrawNewBitmap(void *pixels, int width, int height, int byteStride)
+{
+	uiDrawBitmap *bmp;
+
+	if (width <= 0 || height <= 0)
+		uiprivUserBug("Invalid uiDrawBitmap size %dx%d.", width, height);
+	if (byteStride < width * 4 || (byteStride % 4) != 0)
+		uiprivUserBug("Invalid uiDrawBitmap stride %d for width %d; it must be a multiple of 4 and at least width * 4.", byteStride, width);
+
+	bmp = uiprivNew(uiDrawBitmap);
+	bmp->surface = cairo_image_surface_create_for_data((unsigned char *) pixels,
+		CAIRO_FORMAT_ARGB32,
+		width, height, byteStride);
+	if (cairo_surface_status(bmp->surface) != CAIRO_STATUS_SUCCESS)
+		uiprivImplBug("error creating bitmap surface in uiDrawNewBitmap(): %s",
+			cairo_status_to_string(cairo_surface_status(bmp->surface)));
+	bmp->width = width;
+	bmp->height = height;
+	return bmp;
+}
+
+void uiDrawFreeBitmap(uiDrawBitmap *bmp)
+{
+	// this does not touch the pixels; they belong to the caller
+	cairo_surface_destroy(bmp->surface);
+	uiprivFree(bmp);
+}
+
+void uiDrawBitmapMarkDirty(uiDrawBitmap *bmp, int x, int y, int width, int height)
+{
+	if (x < 0 || y < 0 || width < 0 || height < 0 || x + width > bmp->width || y + height > bmp->height) {
+		uiprivUserBug("Region %dx%d at (%d, %d) is outside of the %dx%d uiDrawBitmap %p.", width, height, x, y, bmp->width, bmp->height, bmp);
+		return;
+	}
+	// cairo requires a flush before it is told about outside changes, in case it still has work queued against the surface
+	cairo_surface_flush(bmp->surface);
+	// this drops whatever copies cairo made of the region (for instance, X server pixmaps) so the next draw picks up the new pixels
+	cairo_surface_mark_dirty_rectangle(bmp->surface, x, y, width, height);
+}
+
+void uiDrawBitmapCopyRGBA(uiDrawBitmap *bmp, int x, int y, const void *pixels, int width, int height, int byteStride, int premultiplied)
+{
+	uint8_t *data;
+	int stride;
+
+	if (x < 0 || y < 0 || width < 0 || height < 0 || x + width > bmp->width || y + height > bmp->height) {
+		uiprivUserBug("Region %dx%d at (%d, %d) is outside of the %dx%d uiDrawBitmap %p.", width, height, x, y, bmp->width, bmp->height, bmp);
+		return;
+	}
+	cairo_surface_flush(bmp->surface);
+	data = cairo_image_surface_get_data(bmp->surface);
+	stride = cairo_image_surface_get_stride(bmp->surface);
+	uiprivRGBAToARGB32(data + y * stride + x * 4, stride,
+		pixels, byteStride,
+		width, height, !premultiplied);
+	cairo_surface_mark_dirty_rectangle(bmp->surface, x, y, width, height);
+}
+
+void uiDrawBlit(uiDrawContext *c, uiDrawBitmap *bmp, double x, double y, double width, double height, uiDrawBitmapFilter filter)
+{
+	cairo_pattern_t *pat;
+	uint64_t start;
+
+	if (filter < uiDrawBitmapFilterNearest || filter > uiDrawBitmapFilterBilinear) {
+		uiprivUserBug("Unknown uiDrawBitmapFilter %d.", (int) filter);
+		return;
+	}
+	if (width <= 0 || height <= 0)
+		return;
+	start = uiprivDrawStatsBegin(c);
+	cairo_save(c->cr);
+	cairo_translate(c->cr, x, y);
+	cairo_scale(c->cr,
+		width / bmp->width,
+		height / bmp->height);
+	cairo_set_source_surface(c->cr, bmp->surface, 0, 0);
+	pat = cairo_get_source(c->cr);
+	cairo_pattern_set_filter(pat, filters[filter]);
+	// without this, bilinear filtering blends the outermost pixels with transparency
+	cairo_pattern_set_extend(pat, CAIRO_EXTEND_PAD);
+	cairo_new_path(c->cr);
+	cairo_rectangle(c->cr, 0, 0, bmp->width, bmp->height);
+	cairo_fill(c->cr);
+	cairo_restore(c->cr);
+	if (c->stats != NULL) {
+		c->stats->Fills++;
+		c->stats->PathSegments++;
+		uiprivDrawStatsEnd(c, start);
+	}
+}
@@ -6,6 +6,15 @@ struct uiDrawPath {
 	GArray *pieces;
 	uiDrawFillMode fillMode;
 	gboolean ended;
+
+	// geometry caches; an ended path can't change, so these are filled in on first use and kept until the path is freed
+	gboolean haveFillBounds;
+	double fillBounds[4];
+	gboolean haveStrokeBounds;
+	uiDrawStrokeParams strokeBoundsParams;		// Dashes is our own copy
+	double strokeBounds[4];
+	cairo_path_t *flat;
+	double length;
 };
 
 struct piece {
@@ -36,6 +45,10 @@ uiDrawPath *uiDrawNewPath(uiDrawFillMode mode)
 
 void uiDrawFreePath(uiDrawPath *p)
 {
+	if (p->strokeBoundsParams.Dashes != NULL)
+		uiprivFree(p->strokeBoundsParams.Dashes);
+	if (p->flat != NULL)
+		cairo_path_destroy(p->flat);
 	g_array_free(p->pieces, TRUE);
 	uiprivFree(p);
 }
@@ -143,7 +156,8 @@ int uiDrawPathEnded(uiDrawPath *p)
 	return p->ended == TRUE ? 1 : 0;
 }
 
-void uiprivRunPath(uiDrawPath *p, cairo_t *cr)
+// returns the number of pieces, for uiAreaDrawStats
+size_t uiprivRunPath(uiDrawPath *p, cairo_t *cr)
 {
 	guint i;
 	struct piece *piece;
@@ -196,9 +210,249 @@ void uiprivRunPath(uiDrawPath *p, cairo_t *cr)
 			break;
 		}
 	}
+	return p->pieces->len;
 }
 
 uiDrawFillMode uiprivPathFillMode(uiDrawPath *path)
 {
 	return path->fillMode;
 }
+
+// measuring and hit-testing paths needs a cairo context but no drawing, so all of it goes through one tiny scratch context
+// these queries also run in draw handlers on the tile rendering threads, so every thread gets a scratch context of its own; a thread's is destroyed when the thread exits
+static GPrivate scratch = G_PRIVATE_INIT((GDestroyNotify) cairo_destroy);
+
+static cairo_t *scratchContext(void)
+{
+	cairo_surface_t *surface;
+	cairo_t *cr;
+
+	cr = (cairo_t *) g_private_get(&scratch);
+	if (cr == NULL) {
+		surface = cairo_image_surface_create(CAIRO_FORMAT_A8, 1, 1);
+		cr = cairo_create(surface);
+		// the context holds its own reference
+		cairo_surface_destroy(surface);
+		g_private_set(&scratch, cr);
+	}
+	return cr;
+}
+
+// the main thread doesn't exit at uiUninit(), so destroy its scratch context now
+void uiprivUninitDrawPath(void)
+{
+	g_private_replace(&scratch, NULL);
+}
+
+static cairo_t *loadScratch(uiDrawPath *p, const uiDrawStrokeParams *stroke)
+{
+	cairo_t *cr;
+
+	cr = scratchContext();
+	uiprivRunPath(p, cr);
+	if (stroke != NULL) {
+		uiprivSetStrokeParams(cr, (uiDrawStrokeParams *) stroke);
+		return cr;
+	}
+	switch (p->fillMode) {
+	case uiDrawFillModeWinding:
+		cairo_set_fill_rule(cr, CAIRO_FILL_RULE_WINDING);
+		break;
+	case uiDrawFillModeAlternate:
+		cairo_set_fill_rule(cr, CAIRO_FILL_RULE_EVEN_ODD);
+		break;
+	}
+	return cr;
+}
+
+static void extents(uiDrawPath *p, const uiDrawStrokeParams *stroke, double bounds[4])
+{
+	cairo_t *cr;
+	double x0, y0, x1, y1;
+
+	cr = loadScratch(p, stroke);
+	if (stroke != NULL)
+		cairo_stroke_extents(cr, &x0, &y0, &x1, &y1);
+	else
+		cairo_fill_extents(cr, &x0, &y0, &x1, &y1);
+	cairo_new_path(cr);
+	bounds[0] = x0;
+	bounds[1] = y0;
+	bounds[2] = x1 - x0;
+	bounds[3] = y1 - y0;
+}
+
+static gboolean sameStrokeParams(const uiDrawStrokeParams *a, const uiDrawStrokeParams *b)
+{
+	if (a->Cap != b->Cap || a->Join != b->Join)
+		return FALSE;
+	if (a->Thickness != b->Thickness || a->MiterLimit != b->MiterLimit)
+		return FALSE;
+	if (a->NumDashes != b->NumDashes || a->DashPhase != b->DashPhase)
+		return FALSE;
+	if (a->NumDashes == 0)
+		return TRUE;
+	return memcmp(a->Dashes, b->Dashes, a->NumDashes * sizeof (double)) == 0;
+}
+
+static const double *cachedBounds(uiDrawPath *p, const uiDrawStrokeParams *stroke)
+{
+	if (!p->ended)
+		uiprivUserBug("You cannot measure a uiDrawPath that has not been ended. (path: %p)", p);
+	if (stroke == NULL) {
+		if (!p->haveFillBounds) {
+			extents(p, NULL, p->fillBounds);
+			p->haveFillBounds = TRUE;
+		}
+		return p->fillBounds;
+	}
+	// only the last stroke is remembered; a path is almost always stroked the same way every time
+	if (p->haveStrokeBounds && sameStrokeParams(&(p->strokeBoundsParams), stroke))
+		return p->strokeBounds;
+	if (p->strokeBoundsParams.Dashes != NULL)
+		uiprivFree(p->strokeBoundsParams.Dashes);
+	p->strokeBoundsParams = *stroke;
+	p->strokeBoundsParams.Dashes = NULL;
+	if (stroke->NumDashes != 0) {
+		p->strokeBoundsParams.Dashes = (double *) uiprivAlloc(stroke->NumDashes * sizeof (double), "double[]");
+		memcpy(p->strokeBoundsParams.Dashes, stroke->Dashes, stroke->NumDashes * sizeof (double));
+	}
+	extents(p, stroke, p->strokeBounds);
+	p->haveStrokeBounds = TRUE;
+	return p->strokeBounds;
+}
+
+void uiDrawPathBounds(uiDrawPath *p, const uiDrawStrokeParams *stroke, double *x, double *y, double *width, double *height)
+{
+	const double *b;
+
+	b = cachedBounds(p, stroke);
+	*x = b[0];
+	*y = b[1];
+	*width = b[2];
+	*height = b[3];
+}
+
+int uiDrawPathContainsPoint(uiDrawPath *p, const uiDrawStrokeParams *stroke, double x, double y)
+{
+	const double *b;
+	cairo_t *cr;
+	cairo_bool_t in;
+
+	// most points are nowhere near a given path; the cached bounds answer those without replaying the path
+	b = cachedBounds(p, stroke);
+	if (x < b[0] || y < b[1] || x > b[0] + b[2] || y > b[1] + b[3])
+		return 0;
+	cr = loadScratch(p, stroke);
+	if (stroke != NULL)
+		in = cairo_in_stroke(cr, x, y);
+	else
+		in = cairo_in_fill(cr, x, y);
+	cairo_new_path(cr);
+	return in != 0;
+}
+
+static cairo_path_t *flatPath(uiDrawPath *p)
+{
+	cairo_t *cr;
+	cairo_path_data_t *d;
+	double startX, startY;
+	double curX, curY;
+	int i;
+
+	if (!p->ended)
+		uiprivUserBug("You cannot measure a uiDrawPath that has not been ended. (path: %p)", p);
+	if (p->flat != NULL)
+		return p->flat;
+	cr = loadScratch(p, NULL);
+	p->flat = cairo_copy_path_flat(cr);
+	cairo_new_path(cr);
+
+	// every point is a line end after flattening, so we can measure the length while we're here
+	p->length = 0;
+	startX = startY = curX = curY = 0;
+	for (i = 0; i < p->flat->num_data; i += d->header.length) {
+		d = &(p->flat->data[i]);
+		switch (d->header.type) {
+		case CAIRO_PATH_MOVE_TO:
+			startX = curX = d[1].point.x;
+			startY = curY = d[1].point.y;
+			break;
+		case CAIRO_PATH_LINE_TO:
+			p->length += hypot(d[1].point.x - curX, d[1].point.y - curY);
+			curX = d[1].point.x;
+			curY = d[1].point.y;
+			break;
+		case CAIRO_PATH_CLOSE_PATH:
+			p->length += hypot(startX - curX, startY - curY);
+			curX = startX;
+			curY = startY;
+			break;
+		case CAIRO_PATH_CURVE_TO:
+			// can't happen in a flattened path
+			break;
+		}
+	}
+	return p->flat;
+}
+
+double uiDrawPathLength(uiDrawPath *p)
+{
+	flatPath(p);
+	return p->length;
+}
+
+size_t uiDrawPathFlatten(uiDrawPath *p, double *points, int *newFigure, size_t n)
+{
+	cairo_path_t *flat;
+	cairo_path_data_t *d;
+	double startX, startY;
+	double x, y;
+	int isNew;
+	gboolean closed;
+	size_t count;
+	int i;
+
+	flat = flatPath(p);
+	count = 0;
+	startX = startY = 0;
+	closed = FALSE;
+	for (i = 0; i < flat->num_data; i += d->header.length) {
+		d = &(flat->data[i]);
+		isNew = -1;
+		switch (d->header.type) {
+		case CAIRO_PATH_MOVE_TO:
+			// cairo adds a move back to the start after every close; that isn't a new figure for us, and the close already emitted its point
+			if (closed && d[1].point.x == startX && d[1].point.y == startY)
+				break;
+			startX = x = d[1].point.x;
+			startY = y = d[1].point.y;
+			isNew = 1;
+			break;
+		case CAIRO_PATH_LINE_TO:
+			x = d[1].point.x;
+			y = d[1].point.y;
+			isNew = 0;
+			break;
+		case CAIRO_PATH_CLOSE_PATH:
+			x = startX;
+			y = startY;
+			isNew = 0;
+			break;
+		case CAIRO_PATH_CURVE_TO:
+			// can't happen in a flattened path
+			break;
+		}
+		closed = d->header.type == CAIRO_PATH_CLOSE_PATH;
+		if (isNew == -1)
+			continue;
+		if (count < n) {
+			points[count * 2] = x;
+			points[count * 2 + 1] = y;
+			if (newFigure != NULL)
+				newFigure[count] = isNew;
+		}
+		count++;
+	}
+	return count;
+}
@@ -5,13 +5,278 @@
 
 struct uiDrawTextLayout {
 	PangoLayout *layout;
+	struct lineTable *lines;		// owned by layout
 };
 
+static GQuark lineTableQuark(void);
+static struct lineTable *newLineTable(PangoLayout *layout);
+
 // we need a context for a few things
 // the documentation suggests creating cairo_t-specific, GdkScreen-specific, or even GtkWidget-specific contexts, but we can't really do that because we want our uiDrawTextFonts and uiDrawTextLayouts to be context-independent
 // we could use pango_font_map_create_context(pango_cairo_font_map_get_default()) but that will ignore GDK-specific settings
-// so let's use gdk_pango_context_get() instead; even though it's for the default screen only, it's good enough for us
-#define mkGenericPangoCairoContext() (gdk_pango_context_get())
+// so let's use gdk_pango_context_get_for_screen() instead; even though it's for the default screen only, it's good enough for us
+// setting up a context isn't free, and Pango only reuses its resolved fonts for the same context, so the main thread keeps one around for as long as the screen's font settings stay the same
+// (layouts take their own reference, so dropping ours when the settings change leaves existing layouts alone)
+// other threads (asynchronous area tiles) must not touch GDK or the shared context; they get a plain context from their own thread's font map each time
+static GThread *mainThread = NULL;
+static PangoContext *sharedContext = NULL;
+static GdkScreen *sharedScreen = NULL;
+
+// uiFontDescriptor to PangoFontDescription conversions for the main thread, most recently used first
+// the entry also holds on to the PangoFont the description resolves to, so Pango can't drop it from its own caches between frames
+#define nFontCache 32
+
+struct fontCacheEntry {
+	char *family;
+	double size;
+	uiTextWeight weight;
+	uiTextItalic italic;
+	uiTextStretch stretch;
+	PangoFontDescription *desc;
+	PangoFont *font;
+};
+
+static struct fontCacheEntry fontCache[nFontCache];
+static int nFontCacheEntries = 0;
+
+static void freeFontCacheEntry(struct fontCacheEntry *e)
+{
+	g_free(e->family);
+	pango_font_description_free(e->desc);
+	if (e->font != NULL)
+		g_object_unref(e->font);
+}
+
+// finished layouts of the main thread, keyed on everything that goes into them; uiDrawNewTextLayout() hands out references to the same PangoLayout for the same key
+// sharing is fine because nothing changes a PangoLayout once uiDrawNewTextLayout() returns it
+// the string is identified by its revision, which changes whenever its text or attributes do, so the text itself needn't be compared
+// least recently used entries are at the tail of layoutCacheLRU and are dropped first
+#define nLayoutCache 256
+
+struct layoutCacheEntry {
+	uint64_t revision;
+	char *family;
+	double size;
+	uiTextWeight weight;
+	uiTextItalic italic;
+	uiTextStretch stretch;
+	double width;
+	uiDrawTextAlign align;
+	PangoLayout *layout;
+	GList *link;
+};
+
+static GHashTable *layoutCache = NULL;
+static GQueue layoutCacheLRU = G_QUEUE_INIT;
+static uiDrawTextLayoutCacheStats layoutCacheStats;
+
+static guint layoutCacheEntryHash(gconstpointer key)
+{
+	const struct layoutCacheEntry *e = (const struct layoutCacheEntry *) key;
+	guint h;
+
+	h = (guint) (e->revision ^ (e->revision >> 32));
+	h = h * 31 + g_str_hash(e->family);
+	h = h * 31 + (guint) (e->size * 64);
+	h = h * 31 + (guint) (e->width * 64);
+	h = h * 31 + (guint) e->weight;
+	h = h * 31 + (guint) e->italic;
+	h = h * 31 + (guint) e->stretch;
+	return h * 31 + (guint) e->align;
+}
+
+static gboolean layoutCacheEntryEqual(gconstpointer a, gconstpointer b)
+{
+	const struct layoutCacheEntry *ea = (const struct layoutCacheEntry *) a;
+	const struct layoutCacheEntry *eb = (const struct layoutCacheEntry *) b;
+
+	return ea->revision == eb->revision &&
+		ea->size == eb->size &&
+		ea->width == eb->width &&
+		ea->weight == eb->weight &&
+		ea->italic == eb->italic &&
+		ea->stretch == eb->stretch &&
+		ea->align == eb->align &&
+		strcmp(ea->family, eb->family) == 0;
+}
+
+static void freeLayoutCacheEntry(gpointer data)
+{
+	struct layoutCacheEntry *e = (struct layoutCacheEntry *) data;
+
+	g_free(e->family);
+	g_object_unref(e->layout);
+	uiprivFree(e);
+}
+
+static void clearLayoutCache(void)
+{
+	if (layoutCache == NULL)
+		return;
+	// the table owns the entries
+	g_queue_clear(&layoutCacheLRU);
+	g_hash_table_remove_all(layoutCache);
+}
+
+static void layoutCacheKey(struct layoutCacheEntry *e, uiDrawTextLayoutParams *p)
+{
+	e->revision = uiprivAttributedStringRevision(p->String);
+	e->family = (char *) (p->DefaultFont->Family);
+	e->size = p->DefaultFont->Size;
+	e->weight = p->DefaultFont->Weight;
+	e->italic = p->DefaultFont->Italic;
+	e->stretch = p->DefaultFont->Stretch;
+	// all negative widths mean the same thing
+	e->width = p->Width;
+	if (e->width < 0)
+		e->width = -1;
+	e->align = p->Align;
+}
+
+// returns a new reference, or NULL if the layout isn't cached
+static PangoLayout *lookupLayout(uiDrawTextLayoutParams *p)
+{
+	struct layoutCacheEntry key;
+	struct layoutCacheEntry *e;
+
+	if (layoutCache == NULL)
+		return NULL;
+	layoutCacheKey(&key, p);
+	e = (struct layoutCacheEntry *) g_hash_table_lookup(layoutCache, &key);
+	if (e == NULL)
+		return NULL;
+	g_queue_unlink(&layoutCacheLRU, e->link);
+	g_queue_push_head_link(&layoutCacheLRU, e->link);
+	return (PangoLayout *) g_object_ref(e->layout);
+}
+
+static void cacheLayout(uiDrawTextLayoutParams *p, PangoLayout *layout)
+{
+	struct layoutCacheEntry *e;
+
+	if (layoutCache == NULL)
+		layoutCache = g_hash_table_new_full(layoutCacheEntryHash, layoutCacheEntryEqual, freeLayoutCacheEntry, NULL);
+	if (g_hash_table_size(layoutCache) == nLayoutCache) {
+		e = (struct layoutCacheEntry *) g_queue_pop_tail(&layoutCacheLRU);
+		g_hash_table_remove(layoutCache, e);
+		layoutCacheStats.Evictions++;
+	}
+	e = uiprivNew(struct layoutCacheEntry);
+	layoutCacheKey(e, p);
+	e->family = g_strdup(e->family);
+	e->layout = (PangoLayout *) g_object_ref(layout);
+	g_queue_push_head(&layoutCacheLRU, e);
+	e->link = g_queue_peek_head_link(&layoutCacheLRU);
+	g_hash_table_add(layoutCache, e);
+}
+
+static void invalidateSharedContext(void)
+{
+	int i;
+
+	// the cached layouts were made with the old settings
+	clearLayoutCache();
+	for (i = 0; i < nFontCacheEntries; i++)
+		freeFontCacheEntry(&(fontCache[i]));
+	nFontCacheEntries = 0;
+	if (sharedContext == NULL)
+		return;
+	g_object_unref(sharedContext);
+	sharedContext = NULL;
+}
+
+static void onFontSettingsChanged(GObject *obj, GParamSpec *pspec, gpointer data)
+{
+	invalidateSharedContext();
+}
+
+static void disconnectScreen(void)
+{
+	if (sharedScreen == NULL)
+		return;
+	g_signal_handlers_disconnect_by_func(sharedScreen, onFontSettingsChanged, NULL);
+	g_signal_handlers_disconnect_by_func(gtk_settings_get_for_screen(sharedScreen), onFontSettingsChanged, NULL);
+	sharedScreen = NULL;
+}
+
+static PangoContext *mainThreadContext(void)
+{
+	GdkScreen *screen;
+	GtkSettings *settings;
+
+	screen = gdk_screen_get_default();
+	if (screen != sharedScreen) {
+		invalidateSharedContext();
+		disconnectScreen();
+		sharedScreen = screen;
+		// GTK+ copies the Xft settings into the screen's font options and resolution
+		g_signal_connect(screen, "notify::font-options", G_CALLBACK(onFontSettingsChanged), NULL);
+		g_signal_connect(screen, "notify::resolution", G_CALLBACK(onFontSettingsChanged), NULL);
+		settings = gtk_settings_get_for_screen(screen);
+		g_signal_connect(settings, "notify::gtk-font-name", G_CALLBACK(onFontSettingsChanged), NULL);
+		g_signal_connect(settings, "notify::gtk-fontconfig-timestamp", G_CALLBACK(onFontSettingsChanged), NULL);
+	}
+	if (sharedContext == NULL)
+		sharedContext = gdk_pango_context_get_for_screen(screen);
+	return sharedContext;
+}
+
+static gboolean fontCacheEntryMatches(struct fontCacheEntry *e, const uiFontDescriptor *f)
+{
+	return e->size == f->Size &&
+		e->weight == f->Weight &&
+		e->italic == f->Italic &&
+		e->stretch == f->Stretch &&
+		strcmp(e->family, f->Family) == 0;
+}
+
+// the returned description is borrowed; don't change or free it
+static const PangoFontDescription *cachedFontDescription(PangoContext *context, const uiFontDescriptor *f)
+{
+	struct fontCacheEntry e;
+	int i;
+
+	for (i = 0; i < nFontCacheEntries; i++)
+		if (fontCacheEntryMatches(&(fontCache[i]), f)) {
+			e = fontCache[i];
+			memmove(&(fontCache[1]), &(fontCache[0]), i * sizeof (struct fontCacheEntry));
+			fontCache[0] = e;
+			return e.desc;
+		}
+
+	if (nFontCacheEntries == nFontCache) {
+		nFontCacheEntries--;
+		freeFontCacheEntry(&(fontCache[nFontCacheEntries]));
+	}
+	e.family = g_strdup(f->Family);
+	e.size = f->Size;
+	e.weight = f->Weight;
+	e.italic = f->Italic;
+	e.stretch = f->Stretch;
+	e.desc = uiprivFontDescriptorToPangoFontDescription(f);
+	e.font = pango_context_load_font(context, e.desc);
+	memmove(&(fontCache[1]), &(fontCache[0]), nFontCacheEntries * sizeof (struct fontCacheEntry));
+	fontCache[0] = e;
+	nFontCacheEntries++;
+	return e.desc;
+}
+
+void uiprivInitDrawText(void)
+{
+	mainThread = g_thread_self();
+}
+
+void uiprivUninitDrawText(void)
+{
+	invalidateSharedContext();
+	disconnectScreen();
+	if (layoutCache != NULL) {
+		g_hash_table_destroy(layoutCache);
+		layoutCache = NULL;
+	}
+	memset(&layoutCacheStats, 0, sizeof (uiDrawTextLayoutCacheStats));
+	mainThread = NULL;
+}
 
 static const PangoAlignment pangoAligns[] = {
 	[uiDrawTextAlignLeft] = PANGO_ALIGN_LEFT,
@@ -19,41 +284,64 @@ static const PangoAlignment pangoAligns[] = {
 	[uiDrawTextAlignRight] = PANGO_ALIGN_RIGHT,
 };
 
-uiDrawTextLayout *uiDrawNewTextLayout(uiDrawTextLayoutParams *p)
+static void fillLayout(PangoLayout *layout, uiDrawTextLayoutParams *p)
 {
-	uiDrawTextLayout *tl;
-	PangoContext *context;
-	PangoFontDescription *desc;
 	PangoAttrList *attrs;
 	int pangoWidth;
 
-	tl = uiprivNew(uiDrawTextLayout);
-
-	// in this case, the context is necessary to create the layout
-	// the layout takes a ref on the context so we can unref it afterward
-	context = mkGenericPangoCairoContext();
-	tl->layout = pango_layout_new(context);
-	g_object_unref(context);
-
 	// this is safe; pango_layout_set_text() copies the string
-	pango_layout_set_text(tl->layout, uiAttributedStringString(p->String), -1);
-
-	desc = uiprivFontDescriptorToPangoFontDescription(p->DefaultFont);
-	pango_layout_set_font_description(tl->layout, desc);
-	// this is safe; the description is copied
-	pango_font_description_free(desc);
+	pango_layout_set_text(layout, uiAttributedStringString(p->String), -1);
 
 	pangoWidth = cairoToPango(p->Width);
 	if (p->Width < 0)
 		pangoWidth = -1;
-	pango_layout_set_width(tl->layout, pangoWidth);
+	pango_layout_set_width(layout, pangoWidth);
 
-	pango_layout_set_alignment(tl->layout, pangoAligns[p->Align]);
+	pango_layout_set_alignment(layout, pangoAligns[p->Align]);
 
 	attrs = uiprivAttributedStringToPangoAttrList(p);
-	pango_layout_set_attributes(tl->layout, attrs);
+	pango_layout_set_attributes(layout, attrs);
 	pango_attr_list_unref(attrs);
+}
+
+uiDrawTextLayout *uiDrawNewTextLayout(uiDrawTextLayoutParams *p)
+{
+	uiDrawTextLayout *tl;
+	PangoContext *context;
+	PangoFontDescription *desc;
+
+	tl = uiprivNew(uiDrawTextLayout);
+
+	// in this case, the context is necessary to create the layout
+	// the layout takes a ref on the context, so the shared context can go away while the layout lives
+	if (g_thread_self() == mainThread) {
+		tl->layout = lookupLayout(p);
+		if (tl->layout != NULL) {
+			layoutCacheStats.Hits++;
+			tl->lines = (struct lineTable *) g_object_get_qdata(G_OBJECT(tl->layout), lineTableQuark());
+			return tl;
+		}
+		layoutCacheStats.Misses++;
+		context = mainThreadContext();
+		tl->layout = pango_layout_new(context);
+		// this is safe; the description is copied
+		pango_layout_set_font_description(tl->layout,
+			cachedFontDescription(context, p->DefaultFont));
+		fillLayout(tl->layout, p);
+		tl->lines = newLineTable(tl->layout);
+		cacheLayout(p, tl->layout);
+		return tl;
+	}
 
+	// other threads don't share the cache
+	context = pango_font_map_create_context(pango_cairo_font_map_get_default());
+	tl->layout = pango_layout_new(context);
+	g_object_unref(context);
+	desc = uiprivFontDescriptorToPangoFontDescription(p->DefaultFont);
+	pango_layout_set_font_description(tl->layout, desc);
+	pango_font_description_free(desc);
+	fillLayout(tl->layout, p);
+	tl->lines = newLineTable(tl->layout);
 	return tl;
 }
 
@@ -63,13 +351,6 @@ void uiDrawFreeTextLayout(uiDrawTextLayout *tl)
 	uiprivFree(tl);
 }
 
-void uiDrawText(uiDrawContext *c, uiDrawTextLayout *tl, double x, double y)
-{
-	// TODO have an implicit save/restore on each drawing functions instead? and is this correct?
-	cairo_set_source_rgb(c->cr, 0.0, 0.0, 0.0);
-	cairo_move_to(c->cr, x, y);
-	pango_cairo_show_layout(c->cr, tl->layout);
-}
 
 void uiDrawTextLayoutExtents(uiDrawTextLayout *tl, double *width, double *height)
 {
@@ -80,6 +361,235 @@ void uiDrawTextLayoutExtents(uiDrawTextLayout *tl, double *width, double *height
 	*height = pangoToCairo(logical.height);
 }
 
+// the lines of a layout, made by uiDrawNewTextLayout() and kept on the PangoLayout itself
+// that way the table goes away with the layout, and layouts shared through the layout cache only ever make it once
+// nothing changes the table afterwards, so threads drawing the same layout can all read it without locking
+struct lineTableEntry {
+	PangoLayoutLine *line;		// owned by the layout
+	PangoRectangle ink;			// what the glyphs cover; can reach past logical, e.g. for italics and tall accents
+	PangoRectangle logical;
+	int baseline;
+	size_t end;			// start of the next line; PangoLayoutLine doesn't count the line break
+};
+
+struct lineTable {
+	int n;
+	struct lineTableEntry *lines;
+	int overhang;			// the farthest any line's ink reaches above the top of its line; never negative
+};
+
+static GQuark lineTableQuark(void)
+{
+	return g_quark_from_static_string("uiprivLineTable");
+}
+
+static void freeLineTable(gpointer data)
+{
+	struct lineTable *t = (struct lineTable *) data;
+
+	uiprivFree(t->lines);
+	uiprivFree(t);
+}
+
+// this also lays the text out, so every user of a cached layout gets that work done already
+static struct lineTable *newLineTable(PangoLayout *layout)
+{
+	struct lineTable *t;
+	PangoLayoutIter *iter;
+	int i;
+
+	t = uiprivNew(struct lineTable);
+	// there's always at least one line, even for empty text
+	t->n = pango_layout_get_line_count(layout);
+	t->lines = (struct lineTableEntry *) uiprivAlloc(t->n * sizeof (struct lineTableEntry), "struct lineTableEntry[]");
+	iter = pango_layout_get_iter(layout);
+	i = 0;
+	for (;;) {
+		t->lines[i].line = pango_layout_iter_get_line_readonly(iter);
+		pango_layout_iter_get_line_extents(iter, &(t->lines[i].ink), &(t->lines[i].logical));
+		t->lines[i].baseline = pango_layout_iter_get_baseline(iter);
+		if (t->lines[i].logical.y - t->lines[i].ink.y > t->overhang)
+			t->overhang = t->lines[i].logical.y - t->lines[i].ink.y;
+		i++;
+		if (i == t->n || !pango_layout_iter_next_line(iter))
+			break;
+	}
+	pango_layout_iter_free(iter);
+	t->n = i;
+	for (i = 0; i < t->n - 1; i++)
+		t->lines[i].end = t->lines[i + 1].line->start_index;
+	t->lines[t->n - 1].end = strlen(pango_layout_get_text(layout));
+
+	g_object_set_qdata_full(G_OBJECT(layout), lineTableQuark(), t, freeLineTable);
+	return t;
+}
+
+// the last line starting at or before index
+static int lineOfIndex(struct lineTable *t, size_t index)
+{
+	int lo, hi, mid;
+
+	lo = 0;
+	hi = t->n - 1;
+	while (lo < hi) {
+		mid = (lo + hi + 1) / 2;
+		if ((size_t) (t->lines[mid].line->start_index) <= index)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	return lo;
+}
+
+int uiDrawTextLayoutNumLines(uiDrawTextLayout *tl)
+{
+	return tl->lines->n;
+}
+
+void uiDrawTextLayoutLineGetMetrics(uiDrawTextLayout *tl, int line, uiDrawTextLayoutLineMetrics *m)
+{
+	struct lineTable *t;
+	struct lineTableEntry *e;
+
+	t = tl->lines;
+	if (line < 0 || line >= t->n)
+		uiprivUserBug("Invalid line %d passed to uiDrawTextLayoutLineGetMetrics(); the layout has %d lines. (layout: %p)", line, t->n, tl);
+	e = &(t->lines[line]);
+	m->X = pangoToCairo(e->logical.x);
+	m->Y = pangoToCairo(e->logical.y);
+	m->Width = pangoToCairo(e->logical.width);
+	m->Height = pangoToCairo(e->logical.height);
+	m->BaselineY = pangoToCairo(e->baseline);
+	m->Ascent = pangoToCairo(e->baseline - e->logical.y);
+	m->Descent = pangoToCairo(e->logical.y + e->logical.height - e->baseline);
+	m->Start = e->line->start_index;
+	m->End = e->end;
+}
+
+int uiDrawTextLayoutHitTest(uiDrawTextLayout *tl, double x, double y, size_t *pos, int *line)
+{
+	const char *text;
+	int index, trailing;
+	gboolean inside;
+
+	// points outside the text are clamped to the nearest position
+	inside = pango_layout_xy_to_index(tl->layout,
+		cairoToPango(x), cairoToPango(y),
+		&index, &trailing);
+	// trailing is the number of characters to move past index when the point is on the trailing side of a grapheme
+	text = pango_layout_get_text(tl->layout);
+	*pos = g_utf8_offset_to_pointer(text + index, trailing) - text;
+	// use index, not pos; past the end of a wrapped line, pos is already the start of the next
+	if (line != NULL)
+		*line = lineOfIndex(tl->lines, index);
+	return inside;
+}
+
+void uiDrawTextLayoutCaret(uiDrawTextLayout *tl, size_t pos, double *x, double *y, double *height, int *line)
+{
+	PangoRectangle strong;
+
+	pango_layout_get_cursor_pos(tl->layout, pos, &strong, NULL);
+	*x = pangoToCairo(strong.x);
+	*y = pangoToCairo(strong.y);
+	*height = pangoToCairo(strong.height);
+	if (line != NULL)
+		*line = lineOfIndex(tl->lines, pos);
+}
+
+size_t uiDrawTextLayoutRangeRects(uiDrawTextLayout *tl, size_t start, size_t end, double *rects, size_t n)
+{
+	struct lineTable *t;
+	struct lineTableEntry *e;
+	int *ranges;
+	int nRanges;
+	size_t found;
+	size_t lineStart, lineEnd;
+	int i, j;
+
+	t = tl->lines;
+	found = 0;
+	for (i = lineOfIndex(t, start); i < t->n; i++) {
+		e = &(t->lines[i]);
+		lineStart = e->line->start_index;
+		if (end <= lineStart)
+			break;
+		// a range going past the end of the line gets a rectangle out to the edge of the layout, as selections do
+		lineEnd = end;
+		if (lineEnd > e->end)
+			lineEnd = e->end;
+		pango_layout_line_get_x_ranges(e->line,
+			start > lineStart ? start : lineStart, lineEnd,
+			&ranges, &nRanges);
+		for (j = 0; j < nRanges; j++) {
+			if (found < n) {
+				rects[found * 4] = pangoToCairo(ranges[2 * j]);
+				rects[found * 4 + 1] = pangoToCairo(e->logical.y);
+				rects[found * 4 + 2] = pangoToCairo(ranges[2 * j + 1] - ranges[2 * j]);
+				rects[found * 4 + 3] = pangoToCairo(e->logical.height);
+			}
+			found++;
+		}
+		g_free(ranges);
+	}
+	return found;
+}
+
+void uiDrawText(uiDrawContext *c, uiDrawTextLayout *tl, double x, double y)
+{
+	uiDrawBrush b;
+
+	memset(&b, 0, sizeof (uiDrawBrush));
+	b.Type = uiDrawBrushTypeSolid;
+	b.A = 1.0;
+	uiDrawTextWithBrush(c, tl, x, y, &b);
+}
+
+void uiDrawTextWithBrush(uiDrawContext *c, uiDrawTextLayout *tl, double x, double y, uiDrawBrush *b)
+{
+	struct lineTable *t;
+	struct lineTableEntry *e;
+	double clipLeft, clipTop, clipRight, clipBottom;
+	double top;
+	int i;
+	uint64_t start;
+	gboolean created;
+
+	start = uiprivDrawStatsBegin(c);
+	// TODO have an implicit save/restore on each drawing functions instead? and is this correct?
+	created = uiprivSetSource(c->cr, b);
+	// lines are drawn one at a time, the way pango_cairo_show_layout() would, so the ones outside the clip can be skipped without rendering their glyphs
+	cairo_clip_extents(c->cr, &clipLeft, &clipTop, &clipRight, &clipBottom);
+	t = tl->lines;
+	for (i = 0; i < t->n; i++) {
+		e = &(t->lines[i]);
+		// lines are in order, so once even the highest-reaching ink would start below the clip, nothing after this line is visible either
+		if (y + pangoToCairo(e->logical.y - t->overhang) > clipBottom)
+			break;
+		// glyphs can spill out of their line, so cull by what they actually cover; otherwise a line just outside the clip, say of the next tile, would lose the part that reaches into it
+		top = y + pangoToCairo(e->ink.y);
+		if (top > clipBottom || top + pangoToCairo(e->ink.height) < clipTop)
+			continue;
+		if (x + pangoToCairo(e->ink.x) > clipRight || x + pangoToCairo(e->ink.x + e->ink.width) < clipLeft)
+			continue;
+		cairo_move_to(c->cr, x + pangoToCairo(e->logical.x), y + pangoToCairo(e->baseline));
+		pango_cairo_show_layout_line(c->cr, e->line);
+	}
+	if (c->stats != NULL) {
+		c->stats->TextLayouts++;
+		c->stats->Patterns += created;
+		uiprivDrawStatsEnd(c, start);
+	}
+}
+
+void uiDrawTextLayoutCacheStatistics(uiDrawTextLayoutCacheStats *stats)
+{
+	*stats = layoutCacheStats;
+	stats->Entries = 0;
+	if (layoutCache != NULL)
+		stats->Entries = g_hash_table_size(layoutCache);
+}
+
 void uiLoadControlFont(uiFontDescriptor *f)
 {
 	GtkWidget *widget;
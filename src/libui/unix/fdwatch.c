@@ -0,0 +1,103 @@
+// 19 october 2026
+#include "uipriv_unix.h"
+
+// every watch is a GSource of its own with the descriptor added to it, which is what g_unix_fd_add() does too
+// a source of our own makes the watch handle and the source one allocation, and lets edge-triggered watches take the descriptor out of the poll until they're rearmed
+// (just polling for no events wouldn't do: poll() reports hangups and errors regardless, and the loop would spin on them)
+struct uiFDWatch {
+	GSource source;		// must be first
+	gpointer tag;		// NULL while an edge-triggered watch is disarmed
+	int fd;
+	GIOCondition condition;
+	gboolean edge;
+	uiWatchFDCallback *f;
+	void *data;
+	gboolean removed;
+};
+
+static GIOCondition toCondition(int events)
+{
+	GIOCondition c = 0;
+
+	if ((events & uiWatchFDRead) != 0)
+		c |= G_IO_IN | G_IO_PRI;
+	if ((events & uiWatchFDWrite) != 0)
+		c |= G_IO_OUT;
+	// poll() reports these whether asked for or not; ask anyway, so GLib doesn't filter them out
+	return c | G_IO_HUP | G_IO_ERR;
+}
+
+static int fromCondition(GIOCondition c)
+{
+	int events = 0;
+
+	if ((c & (G_IO_IN | G_IO_PRI)) != 0)
+		events |= uiWatchFDRead;
+	if ((c & G_IO_OUT) != 0)
+		events |= uiWatchFDWrite;
+	if ((c & G_IO_HUP) != 0)
+		events |= uiWatchFDHangup;
+	if ((c & (G_IO_ERR | G_IO_NVAL)) != 0)
+		events |= uiWatchFDError;
+	return events;
+}
+
+// GLib holds a reference to the source while this runs, so the callback can remove the watch
+static gboolean watchDispatch(GSource *source, GSourceFunc callback, gpointer data)
+{
+	uiFDWatch *w = (uiFDWatch *) source;
+	int events, keep;
+	int64_t start;
+
+	if (w->tag == NULL)
+		return G_SOURCE_CONTINUE;
+	events = fromCondition(g_source_query_unix_fd(source, w->tag));
+	if (events == 0)
+		return G_SOURCE_CONTINUE;
+	if (w->edge) {
+		g_source_remove_unix_fd(source, w->tag);
+		w->tag = NULL;
+	}
+	start = uiprivMainStatsBegin();
+	keep = (*(w->f))(w, w->fd, events, w->data);
+	uiprivMainStatsEnd(uiMainSourceFDWatch, start, 0);
+	if (!keep && !w->removed)
+		uiMainUnwatchFD(w);
+	return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs watchFuncs = {
+	.dispatch = watchDispatch,
+};
+
+uiFDWatch *uiMainWatchFD(int fd, int events, uiWatchFDCallback *f, void *data)
+{
+	uiFDWatch *w;
+
+	w = (uiFDWatch *) g_source_new(&watchFuncs, sizeof (uiFDWatch));
+	w->fd = fd;
+	w->condition = toCondition(events);
+	w->edge = (events & uiWatchFDEdge) != 0;
+	w->f = f;
+	w->data = data;
+	w->tag = g_source_add_unix_fd(&(w->source), fd, w->condition);
+	g_source_attach(&(w->source), NULL);
+	return w;
+}
+
+void uiMainWatchFDRearm(uiFDWatch *w)
+{
+	if (w->tag != NULL || w->removed)
+		return;
+	w->tag = g_source_add_unix_fd(&(w->source), w->fd, w->condition);
+}
+
+void uiMainUnwatchFD(uiFDWatch *w)
+{
+	if (w->removed)
+		return;
+	w->removed = TRUE;
+	g_source_destroy(&(w->source));
+	// the last reference, unless the watch's callback is running; then the dispatch holds one more
+	g_source_unref(&(w->source));
+}
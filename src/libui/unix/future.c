@@ -13,8 +13,11 @@ static PangoAttribute *(*newBGAlphaAttr)(guint16 alpha) = NULL;
 // added in GTK+ 3.20; we need 3.10
 static void (*gwpIterSetObjectName)(GtkWidgetPath *path, gint pos, const char *name) = NULL;
 
+// added in GTK+ 3.12; we need 3.10
+static void (*gwSetEventCompression)(GdkWindow *window, gboolean event_compression) = NULL;
+
 // note that we treat any error as "the symbols aren't there" (and don't care if dlclose() failed)
-void uiprivLoadFutures(void)
+static void loadFutures(void)
 {
 	void *handle;
 
@@ -27,11 +30,28 @@ void uiprivLoadFutures(void)
 	GET(newFGAlphaAttr, pango_attr_foreground_alpha_new);
 	GET(newBGAlphaAttr, pango_attr_background_alpha_new);
 	GET(gwpIterSetObjectName, gtk_widget_path_iter_set_object_name);
+	GET(gwSetEventCompression, gdk_window_set_event_compression);
 	dlclose(handle);
 }
 
+// the lookups walk the symbol tables of every loaded library, which is a good part of uiInit() for a short-lived program; most never need them, so look them up on first use
+// drawing can happen on worker threads too (see areatiles.c), hence g_once_init_enter()
+static void ensureFutures(void)
+{
+	static gsize loaded = 0;
+	int64_t start;
+
+	if (g_once_init_enter(&loaded)) {
+		start = uiMainTime();
+		loadFutures();
+		uiprivCountDeferredInit(start);
+		g_once_init_leave(&loaded, 1);
+	}
+}
+
 PangoAttribute *uiprivFUTURE_pango_attr_font_features_new(const gchar *features)
 {
+	ensureFutures();
 	if (newFeaturesAttr == NULL)
 		return NULL;
 	return (*newFeaturesAttr)(features);
@@ -39,6 +59,7 @@ PangoAttribute *uiprivFUTURE_pango_attr_font_features_new(const gchar *features)
 
 PangoAttribute *uiprivFUTURE_pango_attr_foreground_alpha_new(guint16 alpha)
 {
+	ensureFutures();
 	if (newFGAlphaAttr == NULL)
 		return NULL;
 	return (*newFGAlphaAttr)(alpha);
@@ -46,6 +67,7 @@ PangoAttribute *uiprivFUTURE_pango_attr_foreground_alpha_new(guint16 alpha)
 
 PangoAttribute *uiprivFUTURE_pango_attr_background_alpha_new(guint16 alpha)
 {
+	ensureFutures();
 	if (newBGAlphaAttr == NULL)
 		return NULL;
 	return (*newBGAlphaAttr)(alpha);
@@ -53,8 +75,18 @@ PangoAttribute *uiprivFUTURE_pango_attr_background_alpha_new(guint16 alpha)
 
 gboolean uiprivFUTURE_gtk_widget_path_iter_set_object_name(GtkWidgetPath *path, gint pos, const char *name)
 {
+	ensureFutures();
 	if (gwpIterSetObjectName == NULL)
 		return FALSE;
 	(*gwpIterSetObjectName)(path, pos, name);
 	return TRUE;
 }
+
+gboolean uiprivFUTURE_gdk_window_set_event_compression(GdkWindow *window, gboolean event_compression)
+{
+	ensureFutures();
+	if (gwSetEventCompression == NULL)
+		return FALSE;
+	(*gwSetEventCompression)(window, event_compression);
+	return TRUE;
+}
@@ -0,0 +1,101 @@
+// 19 october 2026
+#include "uipriv_unix.h"
+
+// all idle work shares one GSource, which only exists while there is work
+// it runs at G_PRIORITY_LOW, below input (G_PRIORITY_DEFAULT), painting (GDK_PRIORITY_REDRAW), and uiQueueMain() (G_PRIORITY_DEFAULT_IDLE), so the main loop only gets to it when none of those is ready
+// each dispatch runs work for one time slice and then goes back to the main loop, which polls again and so sees input that came in meanwhile
+struct idle {
+	uiIdleCallback *f;
+	void *data;
+	struct idle *next;
+};
+
+static struct idle *heads[uiIdlePriorityLow + 1];
+static struct idle *tails[uiIdlePriorityLow + 1];
+static guint idleSource = 0;
+static gint64 timeSlice = 4000;		// in microseconds
+
+static void append(uiIdlePriority priority, struct idle *i)
+{
+	i->next = NULL;
+	if (tails[priority] == NULL)
+		heads[priority] = i;
+	else
+		tails[priority]->next = i;
+	tails[priority] = i;
+}
+
+static gboolean runIdle(gpointer data)
+{
+	struct idle *i;
+	int priority;
+	int more;
+	int64_t start;
+	gint64 deadline;
+
+	deadline = g_get_monotonic_time() + timeSlice;
+	for (;;) {
+		for (priority = uiIdlePriorityHigh; priority <= uiIdlePriorityLow; priority++)
+			if (heads[priority] != NULL)
+				break;
+		if (priority > uiIdlePriorityLow) {
+			idleSource = 0;
+			return G_SOURCE_REMOVE;
+		}
+		i = heads[priority];
+		heads[priority] = i->next;
+		if (heads[priority] == NULL)
+			tails[priority] = NULL;
+		start = uiprivMainStatsBegin();
+		more = (*(i->f))(i->data);
+		uiprivMainStatsEnd(uiMainSourceIdle, start, 0);
+		// to the back of the line, so work of the same priority takes turns
+		if (more)
+			append((uiIdlePriority) priority, i);
+		else
+			uiprivFree(i);
+		if (g_get_monotonic_time() >= deadline)
+			return G_SOURCE_CONTINUE;
+	}
+}
+
+void uiQueueIdle(uiIdlePriority priority, uiIdleCallback *f, void *data)
+{
+	struct idle *i;
+
+	if (priority < uiIdlePriorityHigh || priority > uiIdlePriorityLow) {
+		uiprivUserBug("Unknown uiIdlePriority %d.", (int) priority);
+		return;
+	}
+	i = uiprivNew(struct idle);
+	i->f = f;
+	i->data = data;
+	append(priority, i);
+	if (idleSource == 0)
+		idleSource = g_idle_add_full(G_PRIORITY_LOW, runIdle, NULL, NULL);
+}
+
+void uiQueueIdleSetTimeSlice(int milliseconds)
+{
+	if (milliseconds < 0)
+		milliseconds = 0;
+	timeSlice = (gint64) milliseconds * 1000;
+}
+
+void uiprivUninitIdle(void)
+{
+	struct idle *i;
+	int priority;
+
+	for (priority = uiIdlePriorityHigh; priority <= uiIdlePriorityLow; priority++) {
+		while (heads[priority] != NULL) {
+			i = heads[priority];
+			heads[priority] = i->next;
+			uiprivFree(i);
+		}
+		tails[priority] = NULL;
+	}
+	if (idleSource != 0)
+		g_source_remove(idleSource);
+	idleSource = 0;
+}
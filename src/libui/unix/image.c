@@ -34,9 +34,6 @@ void uiFreeImage(uiImage *i)
 void uiImageAppend(uiImage *i, void *pixels, int pixelWidth, int pixelHeight, int byteStride)
 {
 	cairo_surface_t *cs;
-	uint8_t *data, *pix;
-	int realStride;
-	int x, y;
 
 	// note that this is native-endian
 	cs = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
@@ -46,28 +43,11 @@ void uiImageAppend(uiImage *i, void *pixels, int pixelWidth, int pixelHeight, in
 	}
 	cairo_surface_flush(cs);
 
-	pix = (uint8_t *) pixels;
-	data = (uint8_t *) cairo_image_surface_get_data(cs);
-	realStride = cairo_image_surface_get_stride(cs);
-	for (y = 0; y < pixelHeight; y++) {
-		for (x = 0; x < pixelWidth * 4; x += 4) {
-			union {
-				uint32_t v32;
-				uint8_t v8[4];
-			} v;
-
-			v.v32 = ((uint32_t) (pix[x + 3])) << 24;
-			v.v32 |= ((uint32_t) (pix[x])) << 16;
-			v.v32 |= ((uint32_t) (pix[x + 1])) << 8;
-			v.v32 |= ((uint32_t) (pix[x + 2]));
-			data[x] = v.v8[0];
-			data[x + 1] = v.v8[1];
-			data[x + 2] = v.v8[2];
-			data[x + 3] = v.v8[3];
-		}
-		pix += byteStride;
-		data += realStride;
-	}
+	// uiImage pixels are documented as already premultiplied, so this only reorders the bytes
+	uiprivRGBAToARGB32(cairo_image_surface_get_data(cs),
+		cairo_image_surface_get_stride(cs),
+		pixels, byteStride,
+		pixelWidth, pixelHeight, 0);
 
 	cairo_surface_mark_dirty(cs);
 	g_ptr_array_add(i->images, cs);
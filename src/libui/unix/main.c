@@ -3,36 +3,66 @@
 
 uiInitOptions uiprivOptions;
 
-static GHashTable *timers;
+static uiInitTimings initTimings;
+// subsystems made on first use can be reached from worker threads; see uiprivCountDeferredInit()
+G_LOCK_DEFINE_STATIC(initTimings);
 
 const char *uiInit(uiInitOptions *o)
 {
 	GError *err = NULL;
 	const char *msg;
+	int64_t start, libuiStart;
 
+	start = uiMainTime();
 	uiprivOptions = *o;
 	if (gtk_init_with_args(NULL, NULL, NULL, NULL, NULL, &err) == FALSE) {
 		msg = g_strdup(err->message);
 		g_error_free(err);
 		return msg;
 	}
+	libuiStart = uiMainTime();
+	// everything else is made on first use: the future symbols (future.c), the timer wheel (timer.c), the task pool (async.c), and the text layout cache (drawtext.c)
 	uiprivInitAlloc();
-	uiprivLoadFutures();
-	timers = g_hash_table_new(g_direct_hash, g_direct_equal);
+	uiprivInitDrawText();
+	G_LOCK(initTimings);
+	initTimings.Toolkit = (uint64_t) (libuiStart - start);
+	initTimings.Libui = (uint64_t) (uiMainTime() - libuiStart);
+	initTimings.Total = (uint64_t) (uiMainTime() - start);
+	initTimings.Deferred = 0;
+	G_UNLOCK(initTimings);
 	return NULL;
 }
 
-struct timer;		// TODO get rid of forward declaration
+void uiprivCountDeferredInit(int64_t start)
+{
+	G_LOCK(initTimings);
+	initTimings.Deferred += (uint64_t) (uiMainTime() - start);
+	G_UNLOCK(initTimings);
+}
 
-static void uninitTimer(gpointer key, gpointer value, gpointer data)
+void uiInitStatistics(uiInitTimings *t)
 {
-	uiprivFree((struct timer *) key);
+	G_LOCK(initTimings);
+	*t = initTimings;
+	G_UNLOCK(initTimings);
 }
 
+static void uninitQueued(void);
+static void uninitSteps(void);
+static void uninitInstrumentation(void);
+
 void uiUninit(void)
 {
-	g_hash_table_foreach(timers, uninitTimer, NULL);
-	g_hash_table_destroy(timers);
+	uiprivUninitTimers();
+	// after the workers are gone, nothing queues calls anymore
+	uiprivUninitAsync();
+	uninitQueued();
+	uiprivUninitIdle();
+	uninitSteps();
+	uninitInstrumentation();
+	uiprivUninitTiles();
+	uiprivUninitDrawText();
+	uiprivUninitDraw();
 	uiprivUninitMenus();
 	uiprivUninitAlloc();
 }
@@ -75,6 +105,84 @@ int uiMainStep(int wait)
 	return (*iteration)(block) == FALSE;
 }
 
+int64_t uiMainTime(void)
+{
+	return (int64_t) g_get_monotonic_time() * 1000;
+}
+
+static GPollFD *stepFDs = NULL;
+static gint nStepFDs = 0;
+
+static void uninitSteps(void)
+{
+	g_free(stepFDs);
+	stepFDs = NULL;
+	nStepFDs = 0;
+}
+
+// one iteration of the main context, like g_main_context_iteration(NULL, FALSE), but we also get to see the timeout the sources asked for
+// gtk_main_iteration_do() adds nothing to that but the quit check, which stepsQuit does for us
+static gboolean iterate(GMainContext *ctx, gint *timeout)
+{
+	gint priority, n;
+	gboolean ready;
+
+	g_main_context_prepare(ctx, &priority);
+	while ((n = g_main_context_query(ctx, priority, timeout, stepFDs, nStepFDs)) > nStepFDs) {
+		nStepFDs = n;
+		stepFDs = g_renew(GPollFD, stepFDs, nStepFDs);
+	}
+	if (n != 0)
+		(*g_main_context_get_poll_func(ctx))(stepFDs, (guint) n, 0);
+	ready = g_main_context_check(ctx, priority, stepFDs, n);
+	if (ready)
+		g_main_context_dispatch(ctx);
+	return ready;
+}
+
+int uiMainStepFor(int64_t deadline, uiMainStepResult *result)
+{
+	GMainContext *ctx;
+	uiMainStepResult r;
+	int64_t start, now;
+	gint timeout;
+	gboolean drained;
+
+	ctx = g_main_context_default();
+	if (!g_main_context_acquire(ctx))
+		uiprivUserBug("You cannot call uiMainStepFor() from a thread other than the one running the main loop.");
+	memset(&r, 0, sizeof (uiMainStepResult));
+	start = uiMainTime();
+	drained = FALSE;
+	for (;;) {
+		if (!iterate(ctx, &timeout)) {
+			drained = TRUE;
+			break;
+		}
+		r.Iterations++;
+		if (stepsQuit)
+			break;
+		if (uiMainTime() >= deadline) {
+			r.Pending = g_main_context_pending(ctx);
+			break;
+		}
+	}
+	g_main_context_release(ctx);
+
+	now = uiMainTime();
+	r.Elapsed = now - start;
+	// only an iteration that found nothing to do knows the timeout; the dispatch of any other may have changed it, so the host should come back right away
+	if (!drained)
+		r.NextWakeup = now;
+	else if (timeout < 0)
+		r.NextWakeup = -1;
+	else
+		r.NextWakeup = now + (int64_t) timeout * 1000000;
+	if (result != NULL)
+		*result = r;
+	return !stepsQuit;
+}
+
 // gtk_main_quit() may run immediately, or it may wait for other pending events; "it depends" (thanks mclasen in irc.gimp.net/#gtk+)
 // PostQuitMessage() on Windows always waits, so we must do so too
 // we'll do it by using an idle callback
@@ -93,56 +201,329 @@ void uiQuit(void)
 	gdk_threads_add_idle(quit, NULL);
 }
 
+// uiQueueMain() can be called from any thread, and workers reporting progress call it very often
+// rather than making a GSource per call, calls are pushed onto a lock-free stack, and one idle source runs everything that was pushed since it was added
+// scheduled is 1 from the moment a thread adds that source until the source finds nothing left to run; only the thread that flips it from 0 to 1 adds a source, so a burst of calls costs one wakeup of the main loop
 struct queued {
 	void (*f)(void *);
 	void *data;
+	const void *key;		// for uiQueueMainCoalesced(); NULL otherwise
+	void (*discard)(void *);
+	int64_t queuedAt;		// for uiMainSetInstrumentation(); 0 if it was off
+	struct queued *next;
 };
 
+static struct queued *incoming = NULL;		// newest first; pushed by any thread
+static gint scheduled = 0;
+// calls taken off incoming, oldest first; main thread only
+static struct queued *pending = NULL;
+static struct queued *pendingTail = NULL;
+
+// for uiQueueMainCoalesced(): the calls with a key that haven't started running, by key
+// other threads replace f, data, and discard of these, so they're only touched with the lock held
+G_LOCK_DEFINE_STATIC(coalesced);
+static GHashTable *coalesced = NULL;
+
+// the most time one dispatch of the source spends running calls, in microseconds; anything left over waits for the next dispatch, so input and redraws get their turn in between
+#define queuedBudget 4000
+
+static void takeIncoming(void)
+{
+	struct queued *head, *tail, *next, *reversed;
+
+	do
+		head = (struct queued *) g_atomic_pointer_get(&incoming);
+	while (!g_atomic_pointer_compare_and_exchange(&incoming, head, NULL));
+
+	// run calls in the order they were made
+	tail = head;
+	reversed = NULL;
+	while (head != NULL) {
+		next = head->next;
+		head->next = reversed;
+		reversed = head;
+		head = next;
+	}
+	if (reversed == NULL)
+		return;
+	if (pendingTail == NULL)
+		pending = reversed;
+	else
+		pendingTail->next = reversed;
+	pendingTail = tail;
+}
+
 static gboolean doqueued(gpointer data)
 {
-	struct queued *q = (struct queued *) data;
+	struct queued *q;
+	void (*f)(void *);
+	void *arg;
+	int64_t queuedAt, start;
+	gint64 deadline;
 
-	(*(q->f))(q->data);
-	g_free(q);
-	return FALSE;
+	deadline = g_get_monotonic_time() + queuedBudget;
+	for (;;) {
+		if (pending == NULL)
+			takeIncoming();
+		if (pending == NULL) {
+			// a call pushed between takeIncoming() and here saw scheduled set and didn't add a source, so look once more after clearing it
+			g_atomic_int_set(&scheduled, 0);
+			if (g_atomic_pointer_get(&incoming) == NULL)
+				return G_SOURCE_REMOVE;
+			// and if another thread got in first, its source will run the call
+			if (!g_atomic_int_compare_and_exchange(&scheduled, 0, 1))
+				return G_SOURCE_REMOVE;
+			continue;
+		}
+		if (g_get_monotonic_time() >= deadline)
+			return G_SOURCE_CONTINUE;
+		q = pending;
+		pending = q->next;
+		if (pending == NULL)
+			pendingTail = NULL;
+		// once it's out of the table, a new call with the same key is queued anew instead of replacing this one
+		if (q->key != NULL) {
+			G_LOCK(coalesced);
+			g_hash_table_remove(coalesced, q->key);
+			G_UNLOCK(coalesced);
+		}
+		f = q->f;
+		arg = q->data;
+		queuedAt = q->queuedAt;
+		g_free(q);
+		start = uiprivMainStatsBegin();
+		(*f)(arg);
+		uiprivMainStatsEnd(uiMainSourceQueue, start, queuedAt);
+	}
+}
+
+static void push(struct queued *q)
+{
+	q->queuedAt = uiprivMainStatsBegin();
+	do
+		q->next = (struct queued *) g_atomic_pointer_get(&incoming);
+	while (!g_atomic_pointer_compare_and_exchange(&incoming, q->next, q));
+	if (g_atomic_int_compare_and_exchange(&scheduled, 0, 1))
+		gdk_threads_add_idle(doqueued, NULL);
 }
 
+// we have to use g_new()/g_free() for queued calls because uiprivAlloc() is only safe to call on the main thread
+// for some reason it didn't affect me, but it did affect krakjoe
 void uiQueueMain(void (*f)(void *data), void *data)
 {
 	struct queued *q;
 
-	// we have to use g_new0()/g_free() because uiprivAlloc() is only safe to call on the main thread
-	// for some reason it didn't affect me, but it did affect krakjoe
 	q = g_new0(struct queued, 1);
 	q->f = f;
 	q->data = data;
-	gdk_threads_add_idle(doqueued, q);
+	push(q);
 }
 
-struct timer {
-	int (*f)(void *);
-	void *data;
-};
+void uiQueueMainCoalesced(const void *key, void (*f)(void *data), void *data, void (*discard)(void *data))
+{
+	struct queued *q;
+	void *old;
+	void (*oldDiscard)(void *);
 
-static gboolean doTimer(gpointer data)
+	if (key == NULL) {
+		uiQueueMain(f, data);
+		return;
+	}
+	G_LOCK(coalesced);
+	if (coalesced == NULL)
+		coalesced = g_hash_table_new(g_direct_hash, g_direct_equal);
+	q = (struct queued *) g_hash_table_lookup(coalesced, key);
+	if (q != NULL) {
+		// the call keeps its place in the queue
+		old = q->data;
+		oldDiscard = q->discard;
+		q->f = f;
+		q->data = data;
+		q->discard = discard;
+		G_UNLOCK(coalesced);
+		if (oldDiscard != NULL)
+			(*oldDiscard)(old);
+		return;
+	}
+	q = g_new(struct queued, 1);
+	q->f = f;
+	q->data = data;
+	q->key = key;
+	q->discard = discard;
+	g_hash_table_insert(coalesced, (gpointer) key, q);
+	G_UNLOCK(coalesced);
+	// nothing can run it before it's pushed, so it's fine that the table has it already
+	push(q);
+}
+
+// calls still queued when uiUninit() runs are dropped
+static void uninitQueued(void)
+{
+	struct queued *q;
+
+	takeIncoming();
+	while (pending != NULL) {
+		q = pending;
+		pending = q->next;
+		if (q->discard != NULL)
+			(*(q->discard))(q->data);
+		g_free(q);
+	}
+	pendingTail = NULL;
+	G_LOCK(coalesced);
+	if (coalesced != NULL)
+		g_hash_table_destroy(coalesced);
+	coalesced = NULL;
+	G_UNLOCK(coalesced);
+}
+
+// instrumentation is main thread only, except for uiprivMainInstrumented, which uiQueueMain() reads to decide whether to note the time
+// every callback we run ourselves is timed by uiprivMainStatsBegin() and uiprivMainStatsEnd(); GDK events are timed by putting our handler in front of GTK's
+// the time between two polls of the main context is one iteration; whatever part of it wasn't timed otherwise goes to uiMainSourceOther
+gint uiprivMainInstrumented = 0;
+static uint64_t stallThreshold = 0;
+static uiMainSourceStats sourceStats[uiMainSourceCount];
+static uint64_t iterationTime[uiMainSourceCount];
+static int64_t iterationStart = 0;
+static GPollFunc defaultPoll = NULL;
+
+#define stallsKept 64
+static uiMainStall stalls[stallsKept];
+static size_t nStalls = 0;
+static uiMainStallCallback *onStall = NULL;
+static void *onStallData = NULL;
+
+void uiprivMainStatsEnd(uiMainSource source, int64_t start, int64_t due)
+{
+	uiMainSourceStats *s;
+	uint64_t t;
+
+	// instrumentation was off when the callback started
+	if (start == 0)
+		return;
+	t = (uint64_t) (uiMainTime() - start);
+	s = &(sourceStats[source]);
+	s->Dispatches++;
+	s->Time += t;
+	if (t > s->MaxTime)
+		s->MaxTime = t;
+	iterationTime[source] += t;
+	if (due != 0 && start > due) {
+		t = (uint64_t) (start - due);
+		s->Latency += t;
+		if (t > s->MaxLatency)
+			s->MaxLatency = t;
+	}
+}
+
+static void endIteration(int64_t now)
+{
+	uiMainStall *stall;
+	uint64_t duration, timed;
+	int i;
+
+	duration = (uint64_t) (now - iterationStart);
+	timed = 0;
+	for (i = 0; i < uiMainSourceOther; i++)
+		timed += iterationTime[i];
+	// nested main loops, e.g. of modal dialogs, make the callback that started them outlast the iteration
+	if (timed < duration) {
+		iterationTime[uiMainSourceOther] = duration - timed;
+		sourceStats[uiMainSourceOther].Dispatches++;
+		sourceStats[uiMainSourceOther].Time += duration - timed;
+		if (duration - timed > sourceStats[uiMainSourceOther].MaxTime)
+			sourceStats[uiMainSourceOther].MaxTime = duration - timed;
+	}
+	if (stallThreshold == 0 || duration <= stallThreshold)
+		return;
+	stall = &(stalls[nStalls % stallsKept]);
+	nStalls++;
+	stall->Start = iterationStart;
+	stall->Duration = duration;
+	stall->Culprit = uiMainSourceOther;
+	for (i = 0; i < uiMainSourceCount; i++)
+		if (iterationTime[i] > iterationTime[stall->Culprit])
+			stall->Culprit = (uiMainSource) i;
+	if (onStall != NULL)
+		(*onStall)(stall, onStallData);
+}
+
+static gint instrumentedPoll(GPollFD *fds, guint n, gint timeout)
+{
+	gint ret;
+
+	if (iterationStart != 0)
+		endIteration(uiMainTime());
+	ret = (*defaultPoll)(fds, n, timeout);
+	memset(iterationTime, 0, sizeof (iterationTime));
+	iterationStart = uiMainTime();
+	return ret;
+}
+
+static void instrumentedEvent(GdkEvent *e, gpointer data)
+{
+	int64_t start;
+
+	start = uiprivMainStatsBegin();
+	gtk_main_do_event(e);
+	uiprivMainStatsEnd(uiMainSourceInput, start, 0);
+}
+
+void uiMainSetInstrumentation(int enable, uint64_t threshold)
 {
-	struct timer *t = (struct timer *) data;
+	GMainContext *ctx;
 
-	if (!(*(t->f))(t->data)) {
-		g_hash_table_remove(timers, t);
-		uiprivFree(t);
-		return FALSE;
+	ctx = g_main_context_default();
+	memset(sourceStats, 0, sizeof (sourceStats));
+	memset(iterationTime, 0, sizeof (iterationTime));
+	nStalls = 0;
+	stallThreshold = threshold;
+	iterationStart = 0;
+	if (enable && defaultPoll == NULL) {
+		defaultPoll = g_main_context_get_poll_func(ctx);
+		g_main_context_set_poll_func(ctx, instrumentedPoll);
+		gdk_event_handler_set(instrumentedEvent, NULL, NULL);
+	} else if (!enable && defaultPoll != NULL) {
+		g_main_context_set_poll_func(ctx, defaultPoll);
+		defaultPoll = NULL;
+		gdk_event_handler_set((GdkEventFunc) gtk_main_do_event, NULL, NULL);
 	}
-	return TRUE;
+	g_atomic_int_set(&uiprivMainInstrumented, enable != 0);
 }
 
-void uiTimer(int milliseconds, int (*f)(void *data), void *data)
+void uiMainSourceStatistics(uiMainSource source, uiMainSourceStats *stats)
 {
-	struct timer *t;
+	if (source < 0 || source >= uiMainSourceCount) {
+		uiprivUserBug("Unknown uiMainSource %d.", (int) source);
+		return;
+	}
+	*stats = sourceStats[source];
+}
+
+size_t uiMainStalls(uiMainStall *out, size_t n)
+{
+	size_t kept, first, i;
+
+	kept = nStalls;
+	if (kept > stallsKept)
+		kept = stallsKept;
+	if (n > kept)
+		n = kept;
+	first = nStalls - n;
+	for (i = 0; i < n; i++)
+		out[i] = stalls[(first + i) % stallsKept];
+	return nStalls;
+}
 
-	t = uiprivNew(struct timer);
-	t->f = f;
-	t->data = data;
-	g_timeout_add(milliseconds, doTimer, t);
-	g_hash_table_add(timers, t);
+void uiMainOnStall(uiMainStallCallback *f, void *data)
+{
+	onStall = f;
+	onStallData = data;
+}
+
+static void uninitInstrumentation(void)
+{
+	uiMainSetInstrumentation(0, 0);
+	onStall = NULL;
+	onStallData = NULL;
 }
@@ -0,0 +1,319 @@
+// 19 october 2026
+#include "uipriv_unix.h"
+
+// every timer used to be its own g_timeout_add() source; with thousands of timers that's thousands of GSources for the main loop to poll
+// instead, all timers live in one hierarchical timer wheel, driven by one GSource whose ready time is the next time anything could be due
+// the wheel counts time in ticks of one millisecond since the first timer was started
+// level 0 has one slot per tick for the next 256 ticks; every slot of level n covers a whole turn of level n - 1
+// when level 0 wraps around, the next slot of level 1 is cascaded: its timers are sorted into level 0 (and likewise up the levels)
+// so adding and removing a timer is constant time, and a timer is touched at most once per level before it fires
+#define wheelBits 8
+#define wheelSlots (1 << wheelBits)
+#define wheelMask (wheelSlots - 1)
+#define wheelLevels 4
+
+struct uiTimerHandle {
+	int (*f)(void *);
+	void *data;
+	guint64 interval;		// in ticks
+	guint64 tolerance;		// in ticks
+	guint64 expires;		// in ticks
+	// the slot the timer is in, if any
+	uiTimerHandle **slot;
+	uiTimerHandle *prev;
+	uiTimerHandle *next;
+	// for timers changed from their own callback
+	gboolean running;
+	gboolean canceled;
+};
+
+static uiTimerHandle *wheel[wheelLevels][wheelSlots];
+static guint64 wheelNow = 0;		// the last tick processed
+static gint64 wheelOrigin = 0;		// monotonic time of tick 0, in microseconds
+static guint nTimers = 0;
+static GSource *wheelSource = NULL;
+
+static guint64 currentTick(void)
+{
+	return (guint64) ((g_get_monotonic_time() - wheelOrigin) / 1000);
+}
+
+// the first tick that hasn't begun yet, or the current one if it begins right now
+// a timer started partway through a tick counts from here; counting from currentTick() would take the part of the tick already gone as a whole millisecond and fire up to one early
+static guint64 nextTick(void)
+{
+	return (guint64) ((g_get_monotonic_time() - wheelOrigin + 999) / 1000);
+}
+
+static void unlinkTimer(uiTimerHandle *t)
+{
+	if (t->slot == NULL)
+		return;
+	if (t->prev != NULL)
+		t->prev->next = t->next;
+	else
+		*(t->slot) = t->next;
+	if (t->next != NULL)
+		t->next->prev = t->prev;
+	t->slot = NULL;
+	t->prev = NULL;
+	t->next = NULL;
+	nTimers--;
+}
+
+// wheelNow can lag behind the current time while the source waits for its next wakeup; filing timers relative to it is still correct, because the wheel catches up one tick at a time
+// expires must not be before wheelNow; see insertTimer()
+static void linkTimer(uiTimerHandle *t)
+{
+	guint64 delta;
+	int level;
+	uiTimerHandle **slot;
+
+	delta = t->expires - wheelNow;
+	for (level = 0; level < wheelLevels - 1; level++)
+		if (delta < ((guint64) 1) << (wheelBits * (level + 1)))
+			break;
+	// anything further out than the whole wheel waits in the farthest slot of the top level and gets cascaded down again
+	if (delta >= ((guint64) 1) << (wheelBits * wheelLevels))
+		slot = &(wheel[level][((wheelNow >> (wheelBits * level)) - 1) & wheelMask]);
+	else
+		slot = &(wheel[level][(t->expires >> (wheelBits * level)) & wheelMask]);
+	t->slot = slot;
+	t->prev = NULL;
+	t->next = *slot;
+	if (t->next != NULL)
+		t->next->prev = t;
+	*slot = t;
+	nTimers++;
+}
+
+// a timer can't be due before the next tick; the current one was processed already
+static void insertTimer(uiTimerHandle *t)
+{
+	if (t->expires <= wheelNow)
+		t->expires = wheelNow + 1;
+	linkTimer(t);
+}
+
+// when is the earliest a timer could be due?
+// exact for timers in level 0; for the higher levels, it's the tick their slot is cascaded, which is never later than their timers are due
+// a cascade can come before the next timer of level 0, so every level has to be looked at
+static gboolean nextWakeup(guint64 *tick)
+{
+	guint64 base, candidate;
+	gboolean found;
+	int level;
+	int i;
+
+	if (nTimers == 0)
+		return FALSE;
+	found = FALSE;
+	for (level = 0; level < wheelLevels; level++) {
+		base = wheelNow >> (wheelBits * level);
+		for (i = 1; i <= wheelSlots; i++)
+			if (wheel[level][(base + i) & wheelMask] != NULL) {
+				candidate = (base + i) << (wheelBits * level);
+				if (!found || candidate < *tick)
+					*tick = candidate;
+				found = TRUE;
+				break;
+			}
+	}
+	return found;
+}
+
+static void updateWakeup(void)
+{
+	guint64 tick;
+
+	if (!nextWakeup(&tick)) {
+		g_source_set_ready_time(wheelSource, -1);
+		return;
+	}
+	g_source_set_ready_time(wheelSource, wheelOrigin + (gint64) tick * 1000);
+}
+
+// moves the timers of a slot to where they belong now; returns the index of the slot
+static int cascade(int level)
+{
+	int index;
+	uiTimerHandle *t, *next;
+
+	index = (int) ((wheelNow >> (wheelBits * level)) & wheelMask);
+	t = wheel[level][index];
+	wheel[level][index] = NULL;
+	for (; t != NULL; t = next) {
+		next = t->next;
+		t->slot = NULL;
+		nTimers--;
+		// this is where timers due at wheelNow itself move to level 0, in time to fire
+		linkTimer(t);
+	}
+	return index;
+}
+
+static void freeTimer(uiTimerHandle *t)
+{
+	unlinkTimer(t);
+	uiprivFree(t);
+}
+
+// timers that are allowed to be late are moved to the next multiple of the largest power of two that fits in their tolerance
+// ticks are counted from the same origin for everyone, so timers due around the same time end up in the same wakeup
+static void coarsen(uiTimerHandle *t)
+{
+	guint64 grain;
+
+	if (t->tolerance == 0)
+		return;
+	grain = 1;
+	while (grain * 2 <= t->tolerance)
+		grain *= 2;
+	t->expires = (t->expires + grain - 1) & ~(grain - 1);
+}
+
+static void fire(uiTimerHandle *t, guint64 now)
+{
+	int keep;
+	int64_t start;
+
+	unlinkTimer(t);
+	t->running = TRUE;
+	start = uiprivMainStatsBegin();
+	keep = (*(t->f))(t->data);
+	// a timer is late by however long after its tick it runs
+	uiprivMainStatsEnd(uiMainSourceTimer, start, (wheelOrigin + (gint64) t->expires * 1000) * 1000);
+	t->running = FALSE;
+	if (t->canceled || !keep) {
+		freeTimer(t);
+		return;
+	}
+	// uiTimerSetInterval() from the callback already put it back
+	if (t->slot != NULL)
+		return;
+	// measure from when it was due, so the timer doesn't drift; but don't try to catch up on missed runs either
+	t->expires += t->interval;
+	if (t->expires <= now)
+		t->expires = nextTick() + t->interval;
+	coarsen(t);
+	insertTimer(t);
+}
+
+static gboolean wheelDispatch(GSource *source, GSourceFunc callback, gpointer data)
+{
+	guint64 now;
+	int level;
+
+	now = currentTick();
+	while (wheelNow < now) {
+		// after a long time without timers there's nothing to cascade; skip straight ahead
+		if (nTimers == 0) {
+			wheelNow = now;
+			break;
+		}
+		wheelNow++;
+		for (level = 1; level < wheelLevels; level++)
+			if (((wheelNow >> (wheelBits * (level - 1))) & wheelMask) != 0 || cascade(level) != 0)
+				break;
+		while (wheel[0][wheelNow & wheelMask] != NULL)
+			fire(wheel[0][wheelNow & wheelMask], now);
+	}
+	updateWakeup();
+	return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs wheelFuncs = {
+	.dispatch = wheelDispatch,
+};
+
+// the wheel and its source are only made when the first timer is started; plenty of programs never start one
+static void ensureWheel(void)
+{
+	int64_t start;
+
+	if (wheelSource != NULL)
+		return;
+	start = uiMainTime();
+	wheelOrigin = g_get_monotonic_time();
+	wheelNow = 0;
+	wheelSource = g_source_new(&wheelFuncs, sizeof (GSource));
+	g_source_set_ready_time(wheelSource, -1);
+	g_source_attach(wheelSource, NULL);
+	uiprivCountDeferredInit(start);
+}
+
+void uiprivUninitTimers(void)
+{
+	int level, i;
+
+	if (wheelSource == NULL)
+		return;
+	for (level = 0; level < wheelLevels; level++)
+		for (i = 0; i < wheelSlots; i++)
+			while (wheel[level][i] != NULL)
+				freeTimer(wheel[level][i]);
+	g_source_destroy(wheelSource);
+	g_source_unref(wheelSource);
+	wheelSource = NULL;
+}
+
+static void schedule(uiTimerHandle *t)
+{
+	ensureWheel();
+	t->expires = nextTick() + t->interval;
+	coarsen(t);
+	// without timers, nothing moves the wheel along; don't make the next dispatch walk through all the idle time
+	if (nTimers == 0)
+		wheelNow = currentTick();
+	insertTimer(t);
+	updateWakeup();
+}
+
+uiTimerHandle *uiNewTimer(int milliseconds, int (*f)(void *data), void *data)
+{
+	uiTimerHandle *t;
+
+	t = uiprivNew(uiTimerHandle);
+	t->f = f;
+	t->data = data;
+	if (milliseconds < 0)
+		milliseconds = 0;
+	t->interval = (guint64) milliseconds;
+	schedule(t);
+	return t;
+}
+
+void uiTimerSetInterval(uiTimerHandle *t, int milliseconds)
+{
+	if (t->canceled)
+		return;
+	unlinkTimer(t);
+	if (milliseconds < 0)
+		milliseconds = 0;
+	t->interval = (guint64) milliseconds;
+	schedule(t);
+}
+
+void uiTimerSetTolerance(uiTimerHandle *t, int milliseconds)
+{
+	if (milliseconds < 0)
+		milliseconds = 0;
+	// takes effect the next time the timer is scheduled
+	t->tolerance = (guint64) milliseconds;
+}
+
+void uiTimerCancel(uiTimerHandle *t)
+{
+	if (t->running) {
+		// fire() frees it when the callback returns
+		t->canceled = TRUE;
+		unlinkTimer(t);
+		return;
+	}
+	freeTimer(t);
+}
+
+void uiTimer(int milliseconds, int (*f)(void *data), void *data)
+{
+	uiNewTimer(milliseconds, f, data);
+}
@@ -46,6 +46,37 @@ extern void uiprivChildSetMargined(uiprivChild *c, int margined);
 // draw.c
 extern uiDrawContext *uiprivNewContext(cairo_t *cr, GtkStyleContext *style);
 extern void uiprivFreeContext(uiDrawContext *);
+extern void uiprivUninitDraw(void);
+
+// areatiles.c
+typedef struct uiprivTileCache uiprivTileCache;
+typedef void (*uiprivTileRenderFunc)(cairo_t *cr, double x, double y, double width, double height, GtkStyleContext *style, void *data);
+extern uiprivTileCache *uiprivNewTileCache(GtkWidget *widget, int tileSize, size_t budget, uiprivTileRenderFunc render, void *renderData);
+extern void uiprivFreeTileCache(uiprivTileCache *tc);
+extern void uiprivTileCacheInvalidate(uiprivTileCache *tc, double x, double y, double width, double height);
+extern void uiprivTileCacheInvalidateAll(uiprivTileCache *tc);
+extern void uiprivTileCacheSetAsync(uiprivTileCache *tc, gboolean async);
+extern void uiprivTileCacheDraw(uiprivTileCache *tc, cairo_t *cr);
+extern void uiprivUninitTiles(void);
+
+// drawtext.c
+extern void uiprivInitDrawText(void);
+extern void uiprivUninitDrawText(void);
+
+// main.c
+extern gint uiprivMainInstrumented;
+#define uiprivMainStatsBegin() (g_atomic_int_get(&uiprivMainInstrumented) ? uiMainTime() : 0)
+extern void uiprivMainStatsEnd(uiMainSource source, int64_t start, int64_t due);
+extern void uiprivCountDeferredInit(int64_t start);
+
+// async.c
+extern void uiprivUninitAsync(void);
+
+// idle.c
+extern void uiprivUninitIdle(void);
+
+// timer.c
+extern void uiprivUninitTimers(void);
 
 // image.c
 extern cairo_surface_t *uiprivImageAppropriateSurface(uiImage *i, GtkWidget *w);
@@ -54,8 +85,8 @@ extern cairo_surface_t *uiprivImageAppropriateSurface(uiImage *i, GtkWidget *w);
 extern GtkCellRenderer *uiprivNewCellRendererButton(void);
 
 // future.c
-extern void uiprivLoadFutures(void);
 extern PangoAttribute *uiprivFUTURE_pango_attr_font_features_new(const gchar *features);
 extern PangoAttribute *uiprivFUTURE_pango_attr_foreground_alpha_new(guint16 alpha);
 extern PangoAttribute *uiprivFUTURE_pango_attr_background_alpha_new(guint16 alpha);
 extern gboolean uiprivFUTURE_gtk_widget_path_iter_set_object_name(GtkWidgetPath *path, gint pos, const char *name);
+extern gboolean uiprivFUTURE_gdk_window_set_event_compression(GdkWindow *window, gboolean event_compression);
@@ -0,0 +1,139 @@
+#include "bench.h"
+
+#include <ui/control.h>
+#include <ui/draw.h>
+#include <ui/init.h>
+#include <ui/main.h>
+#include <ui/window.h>
+
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#define TILE_SIZE        256
+#define VIEW_SIZE        1000
+#define CANVAS_SIZE      4000
+#define CIRCLES_PER_TILE 50000
+
+// the viewport is a little smaller than the window, but still needs 4 x 4 tiles
+#define VISIBLE_TILES 16
+
+struct areaTilesBench
+{
+  uiAreaHandler ah;
+  atomic_int    drawn;
+};
+
+static void
+areaTilesDraw (uiAreaHandler *ah, uiArea *, uiAreaDrawParams *p)
+{
+  struct areaTilesBench *tb      = (struct areaTilesBench *)ah;
+  double                *centers = malloc (CIRCLES_PER_TILE * 2 * sizeof (double));
+  uiDrawBrush            b       = { 0 };
+  unsigned int           seed    = (unsigned int)(p->ClipX * 31 + p->ClipY);
+
+  if (centers == NULL)
+    return;
+
+  // rand() is not thread-safe; a per-tile linear congruential generator also makes every run draw the same thing
+  for (size_t i = 0; i < CIRCLES_PER_TILE * 2; i += 2)
+    {
+      seed           = seed * 1103515245u + 12345u;
+      centers[i]     = p->ClipX + (double)(seed >> 16 & 0x7FFF) * p->ClipWidth / 0x7FFF;
+      seed           = seed * 1103515245u + 12345u;
+      centers[i + 1] = p->ClipY + (double)(seed >> 16 & 0x7FFF) * p->ClipHeight / 0x7FFF;
+    }
+
+  b.Type = uiDrawBrushTypeSolid;
+  b.R    = 0.2;
+  b.G    = 0.4;
+  b.B    = 0.8;
+  b.A    = 0.5;
+  uiDrawFillCircles (p->Context, centers, CIRCLES_PER_TILE, 3, &b, NULL);
+  free (centers);
+
+  atomic_fetch_add (&tb->drawn, 1);
+}
+
+static void
+areaTilesMouseEvent (uiAreaHandler *, uiArea *, uiAreaMouseEvent *)
+{
+}
+
+static void
+areaTilesMouseCrossed (uiAreaHandler *, uiArea *, int)
+{
+}
+
+static void
+areaTilesDragBroken (uiAreaHandler *, uiArea *)
+{
+}
+
+static int
+areaTilesKeyEvent (uiAreaHandler *, uiArea *, uiAreaKeyEvent *)
+{
+  return 0;
+}
+
+/**
+ * @brief Renders the visible tiles of a scrolling area once.
+ *
+ * Besides the total time, this reports the longest stretch the main loop was blocked, which is how long input would
+ * have waited.
+ */
+static void
+runAreaTiles (const char *bench, const int async)
+{
+  struct areaTilesBench tb;
+  uiWindow             *w;
+  uiArea               *a;
+  uint64_t              start;
+  uint64_t              last;
+  uint64_t              stall = 0;
+
+  tb.ah.Draw         = areaTilesDraw;
+  tb.ah.MouseEvent   = areaTilesMouseEvent;
+  tb.ah.MouseCrossed = areaTilesMouseCrossed;
+  tb.ah.DragBroken   = areaTilesDragBroken;
+  tb.ah.KeyEvent     = areaTilesKeyEvent;
+  atomic_init (&tb.drawn, 0);
+
+  w = uiNewWindow ("Benchmark", VIEW_SIZE, VIEW_SIZE, 0);
+  a = uiNewScrollingArea (&tb.ah, CANVAS_SIZE, CANVAS_SIZE);
+  uiAreaSetAsyncTileRendering (a, async);
+  uiAreaSetTileCache (a, TILE_SIZE, (size_t)256 * 1024 * 1024);
+  uiWindowSetChild (w, uiControl (a));
+
+  uiMainSteps ();
+  start = benchNow ();
+  last  = start;
+  uiControlShow (uiControl (w));
+  while (atomic_load (&tb.drawn) < VISIBLE_TILES)
+    {
+      uint64_t now;
+
+      uiMainStep (0);
+      now = benchNow ();
+      if (now - last > stall)
+        stall = now - last;
+      last = now;
+    }
+
+  benchReport (bench, "time", (double)(benchNow () - start), "ns");
+  benchReport (bench, "max_main_loop_stall", (double)stall, "ns");
+
+  uiControlDestroy (uiControl (w));
+}
+
+int
+areaTilesRunBenchmarks (void)
+{
+  if (benchInit () != 0)
+    return 1;
+
+  runAreaTiles ("areatiles.sync", 0);
+  runAreaTiles ("areatiles.async", 1);
+
+  uiUninit ();
+  return 0;
+}
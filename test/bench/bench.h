@@ -0,0 +1,48 @@
+#pragma once
+
+#include <ui/area.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Benchmark run functions.
+ *
+ * Each returns non-zero when the benchmark could not be run.
+ */
+int areaTilesRunBenchmarks (void);
+int drawBatchRunBenchmarks (void);
+int lifecycleRunBenchmarks (void);
+int pixelsRunBenchmarks (void);
+int queueMainRunBenchmarks (void);
+int startupRunBenchmarks (void);
+
+/**
+ * @brief Returns a monotonic timestamp in nanoseconds.
+ */
+uint64_t benchNow (void);
+
+/**
+ * @brief Writes one machine-readable result as a single JSON line on standard output.
+ * @param bench name of the benchmark
+ * @param metric name of the measured quantity
+ * @param value measured value
+ * @param unit unit of @p value, e.g. @p "ns" or @p "items/s"
+ */
+void benchReport (const char *bench, const char *metric, double value, const char *unit);
+
+/**
+ * @brief Initializes LibUI for a benchmark.
+ * @return non-zero on failure; the error has already been reported.
+ */
+int benchInit (void);
+
+/**
+ * @brief Shows a window containing a @p uiArea and runs the main loop until @p draw has been called once.
+ * @param draw drawing callback, invoked from the area's Draw handler
+ * @param data passed to @p draw
+ * @param width of the area in points
+ * @param height of the area in points
+ * @remark Must be called between @p benchInit and @p uiUninit.
+ */
+void benchDrawOnce (void (*draw) (uiAreaDrawParams *params, void *data), void *data, int width, int height);
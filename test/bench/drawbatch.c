@@ -0,0 +1,134 @@
+#include "bench.h"
+
+#include <ui/draw.h>
+#include <ui/init.h>
+
+#include <stdlib.h>
+
+#define NUM_PRIMITIVES 1000000
+#define AREA_SIZE      1000
+
+struct drawBatchData
+{
+  double *rects;
+  double *centers;
+  double *colors;
+};
+
+static void
+drawRectsPerItem (uiAreaDrawParams *p, void *data)
+{
+  const struct drawBatchData *d = data;
+  uiDrawBrush                 b = { 0 };
+  const uint64_t              t = benchNow ();
+
+  b.Type = uiDrawBrushTypeSolid;
+  for (size_t i = 0; i < NUM_PRIMITIVES; i++)
+    {
+      uiDrawPath *path = uiDrawNewPath (uiDrawFillModeWinding);
+
+      uiDrawPathAddRectangle (path, d->rects[i * 4], d->rects[i * 4 + 1], d->rects[i * 4 + 2], d->rects[i * 4 + 3]);
+      uiDrawPathEnd (path);
+      b.R = d->colors[i * 4];
+      b.G = d->colors[i * 4 + 1];
+      b.B = d->colors[i * 4 + 2];
+      b.A = d->colors[i * 4 + 3];
+      uiDrawFill (p->Context, path, &b);
+      uiDrawFreePath (path);
+    }
+
+  benchReport ("drawbatch.rects.peritem", "time", (double)(benchNow () - t), "ns");
+}
+
+static void
+drawRectsBatched (uiAreaDrawParams *p, void *data)
+{
+  const struct drawBatchData *d = data;
+  const uint64_t              t = benchNow ();
+
+  uiDrawFillRectangles (p->Context, d->rects, NUM_PRIMITIVES, NULL, d->colors);
+
+  benchReport ("drawbatch.rects.batched", "time", (double)(benchNow () - t), "ns");
+}
+
+static void
+drawCirclesPerItem (uiAreaDrawParams *p, void *data)
+{
+  const struct drawBatchData *d = data;
+  uiDrawBrush                 b = { 0 };
+  const uint64_t              t = benchNow ();
+
+  b.Type = uiDrawBrushTypeSolid;
+  b.A    = 1;
+  for (size_t i = 0; i < NUM_PRIMITIVES; i++)
+    {
+      uiDrawPath *path = uiDrawNewPath (uiDrawFillModeWinding);
+
+      uiDrawPathNewFigureWithArc (path, d->centers[i * 2], d->centers[i * 2 + 1], 2, 0, 2 * uiPi, 0);
+      uiDrawPathEnd (path);
+      uiDrawFill (p->Context, path, &b);
+      uiDrawFreePath (path);
+    }
+
+  benchReport ("drawbatch.circles.peritem", "time", (double)(benchNow () - t), "ns");
+}
+
+static void
+drawCirclesBatched (uiAreaDrawParams *p, void *data)
+{
+  const struct drawBatchData *d = data;
+  uiDrawBrush                 b = { 0 };
+  const uint64_t              t = benchNow ();
+
+  b.Type = uiDrawBrushTypeSolid;
+  b.A    = 1;
+  uiDrawFillCircles (p->Context, d->centers, NUM_PRIMITIVES, 2, &b, NULL);
+
+  benchReport ("drawbatch.circles.batched", "time", (double)(benchNow () - t), "ns");
+}
+
+int
+drawBatchRunBenchmarks (void)
+{
+  struct drawBatchData d;
+
+  d.rects   = malloc (NUM_PRIMITIVES * 4 * sizeof (double));
+  d.centers = malloc (NUM_PRIMITIVES * 2 * sizeof (double));
+  d.colors  = malloc (NUM_PRIMITIVES * 4 * sizeof (double));
+  if (d.rects == NULL || d.centers == NULL || d.colors == NULL)
+    return 1;
+
+  // a 1000x1000 heatmap of 1x1 cells, colored in bands of 100 so the batched path sees realistic color runs
+  for (size_t i = 0; i < NUM_PRIMITIVES; i++)
+    {
+      d.rects[i * 4]       = (double)(i % AREA_SIZE);
+      d.rects[i * 4 + 1]   = (double)(i / AREA_SIZE);
+      d.rects[i * 4 + 2]   = 1;
+      d.rects[i * 4 + 3]   = 1;
+      d.centers[i * 2]     = (double)(rand () % AREA_SIZE);
+      d.centers[i * 2 + 1] = (double)(rand () % AREA_SIZE);
+      d.colors[i * 4]      = (double)((i / 100) % 10) / 10;
+      d.colors[i * 4 + 1]  = 0.5;
+      d.colors[i * 4 + 2]  = 0.5;
+      d.colors[i * 4 + 3]  = 1;
+    }
+
+  if (benchInit () != 0)
+    {
+      free (d.rects);
+      free (d.centers);
+      free (d.colors);
+      return 1;
+    }
+
+  benchDrawOnce (drawRectsPerItem, &d, AREA_SIZE, AREA_SIZE);
+  benchDrawOnce (drawRectsBatched, &d, AREA_SIZE, AREA_SIZE);
+  benchDrawOnce (drawCirclesPerItem, &d, AREA_SIZE, AREA_SIZE);
+  benchDrawOnce (drawCirclesBatched, &d, AREA_SIZE, AREA_SIZE);
+
+  uiUninit ();
+  free (d.rects);
+  free (d.centers);
+  free (d.colors);
+  return 0;
+}
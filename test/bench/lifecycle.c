@@ -0,0 +1,201 @@
+#include "bench.h"
+
+#include <ui/box.h>
+#include <ui/button.h>
+#include <ui/checkbox.h>
+#include <ui/combobox.h>
+#include <ui/control.h>
+#include <ui/entry.h>
+#include <ui/init.h>
+#include <ui/label.h>
+#include <ui/main.h>
+#include <ui/progressbar.h>
+#include <ui/slider.h>
+#include <ui/spinbox.h>
+#include <ui/window.h>
+
+#include <stdio.h>
+
+#define WINDOW_WIDTH  600
+#define WINDOW_HEIGHT 400
+
+/**
+ * @brief A control type to fill windows with.
+ */
+struct lifecycleControl
+{
+  const char *name;
+  uiControl *(*make) (void);
+};
+
+static uiControl *
+makeLabel (void)
+{
+  return uiControl (uiNewLabel ("Label"));
+}
+
+static uiControl *
+makeButton (void)
+{
+  return uiControl (uiNewButton ("Button"));
+}
+
+static uiControl *
+makeCheckbox (void)
+{
+  return uiControl (uiNewCheckbox ("Checkbox"));
+}
+
+static uiControl *
+makeEntry (void)
+{
+  return uiControl (uiNewEntry ());
+}
+
+static uiControl *
+makeSlider (void)
+{
+  return uiControl (uiNewSlider (0, 100));
+}
+
+static uiControl *
+makeSpinbox (void)
+{
+  return uiControl (uiNewSpinbox (0, 100));
+}
+
+static uiControl *
+makeProgressBar (void)
+{
+  return uiControl (uiNewProgressBar ());
+}
+
+static uiControl *
+makeCombobox (void)
+{
+  uiCombobox *c = uiNewCombobox ();
+
+  uiComboboxAppend (c, "One");
+  uiComboboxAppend (c, "Two");
+  uiComboboxAppend (c, "Three");
+  return uiControl (c);
+}
+
+static const struct lifecycleControl controls[] = {
+  { "label", makeLabel },
+  { "button", makeButton },
+  { "checkbox", makeCheckbox },
+  { "entry", makeEntry },
+  { "slider", makeSlider },
+  { "spinbox", makeSpinbox },
+  { "progressbar", makeProgressBar },
+  { "combobox", makeCombobox },
+};
+
+static const int counts[] = { 10, 100, 1000 };
+
+/**
+ * @brief An area next to the controls; its first Draw call marks the window's first paint.
+ */
+struct lifecycleArea
+{
+  uiAreaHandler ah;
+  int           painted;
+};
+
+static void
+lifecycleDraw (uiAreaHandler *ah, uiArea *, uiAreaDrawParams *)
+{
+  ((struct lifecycleArea *)ah)->painted = 1;
+}
+
+static void
+lifecycleMouseEvent (uiAreaHandler *, uiArea *, uiAreaMouseEvent *)
+{
+}
+
+static void
+lifecycleMouseCrossed (uiAreaHandler *, uiArea *, int)
+{
+}
+
+static void
+lifecycleDragBroken (uiAreaHandler *, uiArea *)
+{
+}
+
+static int
+lifecycleKeyEvent (uiAreaHandler *, uiArea *, uiAreaKeyEvent *)
+{
+  return 0;
+}
+
+/**
+ * @brief Goes through the life of a program the way the unit tests do: init, make a window, paint it once, tear it all
+ * down.
+ */
+static int
+runLifecycle (const struct lifecycleControl *control, const int n)
+{
+  struct lifecycleArea la = { 0 };
+  char                 bench[64];
+  uiWindow            *w;
+  uiBox               *row;
+  uiBox               *column;
+  uint64_t             start;
+  uint64_t             initialized;
+  uint64_t             created;
+  uint64_t             painted;
+  uint64_t             destroyed;
+
+  la.ah.Draw         = lifecycleDraw;
+  la.ah.MouseEvent   = lifecycleMouseEvent;
+  la.ah.MouseCrossed = lifecycleMouseCrossed;
+  la.ah.DragBroken   = lifecycleDragBroken;
+  la.ah.KeyEvent     = lifecycleKeyEvent;
+  snprintf (bench, sizeof (bench), "lifecycle.%s.%d", control->name, n);
+
+  start = benchNow ();
+  if (benchInit () != 0)
+    return 1;
+  initialized = benchNow ();
+
+  // the area stretches across the top of the window whatever the controls add up to, so it is always painted
+  w      = uiNewWindow ("Benchmark", WINDOW_WIDTH, WINDOW_HEIGHT, 0);
+  row    = uiNewHorizontalBox ();
+  column = uiNewVerticalBox ();
+  uiBoxAppend (row, uiControl (uiNewArea (&la.ah)), 1);
+  for (int i = 0; i < n; i++)
+    uiBoxAppend (column, (*control->make) (), 0);
+  uiBoxAppend (row, uiControl (column), 0);
+  uiWindowSetChild (w, uiControl (row));
+  created = benchNow ();
+
+  uiMainSteps ();
+  uiControlShow (uiControl (w));
+  while (!la.painted)
+    uiMainStep (1);
+  painted = benchNow ();
+
+  uiControlDestroy (uiControl (w));
+  destroyed = benchNow ();
+  // includes the walk over the remaining allocations looking for leaks
+  uiUninit ();
+
+  benchReport (bench, "init", (double)(initialized - start), "ns");
+  benchReport (bench, "create", (double)(created - initialized), "ns");
+  benchReport (bench, "first_paint", (double)(painted - created), "ns");
+  benchReport (bench, "destroy", (double)(destroyed - painted), "ns");
+  benchReport (bench, "uninit", (double)(benchNow () - destroyed), "ns");
+  return 0;
+}
+
+int
+lifecycleRunBenchmarks (void)
+{
+  for (size_t i = 0; i < sizeof (controls) / sizeof (*controls); i++)
+    for (size_t j = 0; j < sizeof (counts) / sizeof (*counts); j++)
+      if (runLifecycle (&controls[i], counts[j]) != 0)
+        return 1;
+  return 0;
+}
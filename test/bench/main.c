@@ -0,0 +1,156 @@
+#include "bench.h"
+
+#include <ui/control.h>
+#include <ui/init.h>
+#include <ui/main.h>
+#include <ui/window.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+uint64_t
+benchNow (void)
+{
+#ifdef _WIN32
+  LARGE_INTEGER counter;
+  LARGE_INTEGER frequency;
+
+  QueryPerformanceCounter (&counter);
+  QueryPerformanceFrequency (&frequency);
+  return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void
+benchReport (const char *bench, const char *metric, const double value, const char *unit)
+{
+  printf ("{\"bench\":\"%s\",\"metric\":\"%s\",\"value\":%.6g,\"unit\":\"%s\"}\n", bench, metric, value, unit);
+  fflush (stdout);
+}
+
+int
+benchInit (void)
+{
+  uiInitOptions o   = { 0 };
+  const char   *err = uiInit (&o);
+
+  if (err == NULL)
+    return 0;
+  fprintf (stderr, "uiInit() failed: %s\n", err);
+  uiFreeInitError (err);
+  return 1;
+}
+
+struct benchArea
+{
+  uiAreaHandler ah;
+  void (*draw) (uiAreaDrawParams *params, void *data);
+  void *data;
+  int   drawn;
+};
+
+static void
+benchAreaDraw (uiAreaHandler *ah, uiArea *, uiAreaDrawParams *p)
+{
+  struct benchArea *ba = (struct benchArea *)ah;
+
+  if (ba->drawn)
+    return;
+  (*ba->draw) (p, ba->data);
+  ba->drawn = 1;
+}
+
+static void
+benchAreaMouseEvent (uiAreaHandler *, uiArea *, uiAreaMouseEvent *)
+{
+}
+
+static void
+benchAreaMouseCrossed (uiAreaHandler *, uiArea *, int)
+{
+}
+
+static void
+benchAreaDragBroken (uiAreaHandler *, uiArea *)
+{
+}
+
+static int
+benchAreaKeyEvent (uiAreaHandler *, uiArea *, uiAreaKeyEvent *)
+{
+  return 0;
+}
+
+void
+benchDrawOnce (void (*draw) (uiAreaDrawParams *params, void *data), void *data, const int width, const int height)
+{
+  struct benchArea ba;
+  uiWindow        *w;
+  uiArea          *a;
+
+  ba.ah.Draw         = benchAreaDraw;
+  ba.ah.MouseEvent   = benchAreaMouseEvent;
+  ba.ah.MouseCrossed = benchAreaMouseCrossed;
+  ba.ah.DragBroken   = benchAreaDragBroken;
+  ba.ah.KeyEvent     = benchAreaKeyEvent;
+  ba.draw            = draw;
+  ba.data            = data;
+  ba.drawn           = 0;
+
+  w = uiNewWindow ("Benchmark", width, height, 0);
+  a = uiNewArea (&ba.ah);
+  uiWindowSetChild (w, uiControl (a));
+  uiControlShow (uiControl (w));
+
+  uiMainSteps ();
+  while (!ba.drawn)
+    uiMainStep (1);
+
+  uiControlDestroy (uiControl (w));
+}
+
+struct benchmark
+{
+  const char *name;
+  int (*fn) (void);
+};
+
+int
+main (const int argc, char **argv)
+{
+  int                    failed       = 0;
+  const struct benchmark benchmarks[] = {
+    // first, while the process is still cold
+    { "startup", startupRunBenchmarks },
+    { "areatiles", areaTilesRunBenchmarks },
+    { "drawbatch", drawBatchRunBenchmarks },
+    { "lifecycle", lifecycleRunBenchmarks },
+    { "pixels", pixelsRunBenchmarks },
+    { "queuemain", queueMainRunBenchmarks },
+  };
+
+  // with arguments, only the named benchmarks are run
+  for (size_t i = 0; i < sizeof (benchmarks) / sizeof (*benchmarks); ++i)
+    {
+      int selected = argc < 2;
+
+      for (int j = 1; j < argc; ++j)
+        if (strcmp (argv[j], benchmarks[i].name) == 0)
+          selected = 1;
+      if (selected && (benchmarks[i].fn) () != 0)
+        failed++;
+    }
+
+  return failed;
+}
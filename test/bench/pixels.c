@@ -0,0 +1,53 @@
+#include "bench.h"
+
+#include <ui/draw.h>
+#include <ui/image.h>
+#include <ui/init.h>
+
+#include <stdlib.h>
+
+#define IMAGE_SIZE 4096
+#define REPEAT     10
+
+int
+pixelsRunBenchmarks (void)
+{
+  const size_t   stride = IMAGE_SIZE * 4;
+  uint8_t       *rgba   = malloc (stride * IMAGE_SIZE);
+  uint8_t       *argb   = malloc (stride * IMAGE_SIZE);
+  uiDrawBitmap  *bmp;
+  uint64_t       t;
+  const double   pixels = (double)IMAGE_SIZE * IMAGE_SIZE * REPEAT;
+
+  if (rgba == NULL || argb == NULL || benchInit () != 0)
+    {
+      free (rgba);
+      free (argb);
+      return 1;
+    }
+
+  for (size_t i = 0; i < stride * IMAGE_SIZE; i++)
+    rgba[i] = (uint8_t)(rand () & 0xFF);
+
+  t = benchNow ();
+  for (int i = 0; i < REPEAT; i++)
+    {
+      uiImage *img = uiNewImage (IMAGE_SIZE, IMAGE_SIZE);
+
+      uiImageAppend (img, rgba, IMAGE_SIZE, IMAGE_SIZE, (int)stride);
+      uiFreeImage (img);
+    }
+  benchReport ("pixels.imageappend", "throughput", pixels * 1e9 / (double)(benchNow () - t), "pixels/s");
+
+  bmp = uiDrawNewBitmap (argb, IMAGE_SIZE, IMAGE_SIZE, (int)stride);
+  t   = benchNow ();
+  for (int i = 0; i < REPEAT; i++)
+    uiDrawBitmapCopyRGBA (bmp, 0, 0, rgba, IMAGE_SIZE, IMAGE_SIZE, (int)stride, 0);
+  benchReport ("pixels.bitmapcopy.premultiply", "throughput", pixels * 1e9 / (double)(benchNow () - t), "pixels/s");
+  uiDrawFreeBitmap (bmp);
+
+  uiUninit ();
+  free (rgba);
+  free (argb);
+  return 0;
+}
@@ -0,0 +1,118 @@
+#include "bench.h"
+
+#include <ui/init.h>
+#include <ui/main.h>
+
+#include <stdlib.h>
+#include <threads.h>
+
+#define PRODUCERS          4
+#define POSTS_PER_PRODUCER 250000
+#define POSTS              (PRODUCERS * POSTS_PER_PRODUCER)
+
+struct queueMainBench
+{
+  uint64_t *posted;   //!< time each call was queued, indexed by call
+  int       coalesce; //!< whether to use one coalescing key per producer
+  uint64_t  received;
+  int       finished; //!< producers whose last call has run
+  uint64_t  latencyTotal;
+  uint64_t  latencyMax;
+};
+
+struct producer
+{
+  struct queueMainBench *qb;
+  size_t                 first;
+};
+
+static struct queueMainBench *current;
+
+static void
+queueMainReceive (void *data)
+{
+  struct queueMainBench *qb      = current;
+  const uint64_t        *posted  = data;
+  const uint64_t         latency = benchNow () - *posted;
+  const size_t           i       = (size_t)(posted - qb->posted);
+
+  qb->received++;
+  qb->latencyTotal += latency;
+  if (latency > qb->latencyMax)
+    qb->latencyMax = latency;
+  // calls of one producer run in order, and with coalescing the last one always runs
+  if (i % POSTS_PER_PRODUCER == POSTS_PER_PRODUCER - 1)
+    qb->finished++;
+}
+
+static int
+queueMainProduce (void *data)
+{
+  const struct producer *p = data;
+
+  for (size_t i = p->first; i < p->first + POSTS_PER_PRODUCER; i++)
+    {
+      p->qb->posted[i] = benchNow ();
+      if (p->qb->coalesce)
+        uiQueueMainCoalesced (p, queueMainReceive, &p->qb->posted[i], NULL);
+      else
+        uiQueueMain (queueMainReceive, &p->qb->posted[i]);
+    }
+  return 0;
+}
+
+/**
+ * @brief Floods the main thread with calls from several threads at once.
+ *
+ * Reports how many calls per second got through, how many callbacks the main thread had to run, and how long a call
+ * waited between being queued and running.
+ */
+static void
+runQueueMain (const char *bench, const int coalesce)
+{
+  struct queueMainBench qb = { 0 };
+  struct producer       producers[PRODUCERS];
+  thrd_t                threads[PRODUCERS];
+  uint64_t              start;
+  uint64_t              elapsed;
+
+  qb.posted = malloc (POSTS * sizeof (uint64_t));
+  if (qb.posted == NULL)
+    return;
+  qb.coalesce = coalesce;
+  current     = &qb;
+
+  start = benchNow ();
+  for (int i = 0; i < PRODUCERS; i++)
+    {
+      producers[i].qb    = &qb;
+      producers[i].first = (size_t)i * POSTS_PER_PRODUCER;
+      thrd_create (&threads[i], queueMainProduce, &producers[i]);
+    }
+  while (qb.finished < PRODUCERS)
+    uiMainStep (1);
+  elapsed = benchNow () - start;
+  for (int i = 0; i < PRODUCERS; i++)
+    thrd_join (threads[i], NULL);
+
+  benchReport (bench, "throughput", (double)POSTS * 1e9 / (double)elapsed, "calls/s");
+  benchReport (bench, "callbacks", (double)qb.received, "calls");
+  benchReport (bench, "average_latency", (double)qb.latencyTotal / (double)qb.received, "ns");
+  benchReport (bench, "max_latency", (double)qb.latencyMax, "ns");
+
+  free (qb.posted);
+}
+
+int
+queueMainRunBenchmarks (void)
+{
+  if (benchInit () != 0)
+    return 1;
+
+  uiMainSteps ();
+  runQueueMain ("queuemain", 0);
+  runQueueMain ("queuemain.coalesced", 1);
+
+  uiUninit ();
+  return 0;
+}
@@ -0,0 +1,43 @@
+#include "bench.h"
+
+#include <ui/init.h>
+#include <ui/main.h>
+
+#define WINDOW_SIZE 400
+
+static void
+startupDraw (uiAreaDrawParams *, void *data)
+{
+  uint64_t *painted = data;
+
+  *painted = benchNow ();
+}
+
+int
+startupRunBenchmarks (void)
+{
+  uiInitTimings t;
+  uint64_t      start;
+  uint64_t      initialized;
+  uint64_t      painted = 0;
+
+  // the toolkit is only really set up by the first uiInit() of the process, so this has to be the first benchmark run
+  start = benchNow ();
+  if (benchInit () != 0)
+    return 1;
+  initialized = benchNow ();
+  uiInitStatistics (&t);
+
+  // an empty area stands in for the first window's contents; its Draw handler runs when the window is first painted
+  benchDrawOnce (startupDraw, &painted, WINDOW_SIZE, WINDOW_SIZE);
+
+  benchReport ("startup", "init", (double)(initialized - start), "ns");
+  benchReport ("startup", "init_toolkit", (double)t.Toolkit, "ns");
+  benchReport ("startup", "init_libui", (double)t.Libui, "ns");
+  benchReport ("startup", "time_to_first_window", (double)(painted - start), "ns");
+  uiInitStatistics (&t);
+  benchReport ("startup", "deferred_init", (double)t.Deferred, "ns");
+
+  uiUninit ();
+  return 0;
+}
@@ -0,0 +1,148 @@
+#include "unit.h"
+
+#include <ui/async.h>
+#include <ui/init.h>
+#include <ui/main.h>
+
+#include <stdatomic.h>
+
+#define asyncUnitTest(f) cmocka_unit_test_setup_teardown ((f), asyncTestSetup, asyncTestTeardown)
+
+#define TASKS 1000
+#define DEPTH 8
+
+struct counts
+{
+  atomic_int worked;
+  int        done;
+  int        canceled;
+  atomic_int release;
+};
+
+static int
+asyncTestSetup (void **state)
+{
+  uiInitOptions o = { 0 };
+
+  assert_no_error (uiInit (&o));
+  uiMainSteps ();
+  *state = calloc (1, sizeof (struct counts));
+  assert_non_null (*state);
+  return 0;
+}
+
+static int
+asyncTestTeardown (void **state)
+{
+  uiUninit ();
+  // after uiUninit(), so workers still running don't touch freed memory
+  free (*state);
+  uiAsyncSetWorkers (0);
+  return 0;
+}
+
+static void
+countWork (uiAsyncTask *, void *data)
+{
+  struct counts *c = data;
+
+  atomic_fetch_add (&c->worked, 1);
+}
+
+static void
+countDone (uiAsyncTask *, const int canceled, void *data)
+{
+  struct counts *c = data;
+
+  c->done++;
+  if (canceled)
+    c->canceled++;
+}
+
+static void
+waitForDone (struct counts *c, const int n)
+{
+  while (c->done < n)
+    uiMainStep (1);
+}
+
+static void
+asyncDone (void **state)
+{
+  struct counts *c = *state;
+
+  for (int i = 0; i < TASKS; i++)
+    uiRunAsync (countWork, countDone, c);
+  waitForDone (c, TASKS);
+  assert_int_equal (atomic_load (&c->worked), TASKS);
+  assert_int_equal (c->canceled, 0);
+}
+
+static struct counts *splitCounts;
+
+static void
+splitWork (uiAsyncTask *, void *data)
+{
+  const intptr_t depth = (intptr_t)data;
+
+  atomic_fetch_add (&splitCounts->worked, 1);
+  if (depth == 0)
+    return;
+  uiRunAsync (splitWork, NULL, (void *)(depth - 1));
+  uiRunAsync (splitWork, NULL, (void *)(depth - 1));
+}
+
+static void
+asyncSplit (void **state)
+{
+  struct counts *c = *state;
+
+  // tasks started from workers, with the pool shrunk and grown while they run
+  splitCounts = c;
+  uiRunAsync (splitWork, NULL, (void *)(intptr_t)DEPTH);
+  uiAsyncSetWorkers (1);
+  uiAsyncSetWorkers (3);
+  while (atomic_load (&c->worked) < (2 << DEPTH) - 1)
+    uiMainStep (0);
+  assert_int_equal (atomic_load (&c->worked), (2 << DEPTH) - 1);
+}
+
+static void
+blockWork (uiAsyncTask *, void *data)
+{
+  struct counts *c = data;
+
+  atomic_fetch_add (&c->worked, 1);
+  while (!atomic_load (&c->release))
+    ;
+}
+
+static void
+asyncCancel (void **state)
+{
+  struct counts *c = *state;
+  uiAsyncTask   *t;
+
+  // with one worker busy, the second task can't have started when it's canceled
+  uiAsyncSetWorkers (1);
+  uiRunAsync (blockWork, countDone, c);
+  t = uiRunAsync (countWork, countDone, c);
+  uiAsyncCancel (t);
+  assert_true (uiAsyncCanceled (t));
+  atomic_store (&c->release, 1);
+  waitForDone (c, 2);
+  assert_int_equal (c->canceled, 1);
+  assert_int_equal (atomic_load (&c->worked), 1);
+}
+
+int
+asyncRunUnitTests (void)
+{
+  const struct CMUnitTest tests[] = {
+    asyncUnitTest (asyncDone),
+    asyncUnitTest (asyncSplit),
+    asyncUnitTest (asyncCancel),
+  };
+
+  return cmocka_run_group_tests_name ("uiRunAsync", tests, NULL, NULL);
+}
@@ -0,0 +1,115 @@
+#include "unit.h"
+
+#include <ui/draw.h>
+#include <ui/init.h>
+
+#define drawPathUnitTest(f) cmocka_unit_test_setup_teardown ((f), drawPathTestSetup, drawPathTestTeardown)
+
+#define EPSILON 0.001
+
+static int
+drawPathTestSetup (void **state)
+{
+  uiInitOptions o = { 0 };
+  uiDrawPath   *p;
+
+  assert_no_error (uiInit (&o));
+  p = uiDrawNewPath (uiDrawFillModeWinding);
+  uiDrawPathAddRectangle (p, 10, 20, 30, 40);
+  uiDrawPathEnd (p);
+  *state = p;
+  return 0;
+}
+
+static int
+drawPathTestTeardown (void **state)
+{
+  uiDrawFreePath (*state);
+  uiUninit ();
+  return 0;
+}
+
+static void
+drawPathBounds (void **state)
+{
+  uiDrawStrokeParams sp = { 0 };
+  double             x, y, width, height;
+
+  uiDrawPathBounds (*state, NULL, &x, &y, &width, &height);
+  assert_float_equal (x, 10, EPSILON);
+  assert_float_equal (y, 20, EPSILON);
+  assert_float_equal (width, 30, EPSILON);
+  assert_float_equal (height, 40, EPSILON);
+
+  // half the stroke is outside the fill
+  sp.Cap        = uiDrawLineCapFlat;
+  sp.Join       = uiDrawLineJoinMiter;
+  sp.Thickness  = 4;
+  sp.MiterLimit = uiDrawDefaultMiterLimit;
+  uiDrawPathBounds (*state, &sp, &x, &y, &width, &height);
+  assert_float_equal (x, 8, EPSILON);
+  assert_float_equal (y, 18, EPSILON);
+  assert_float_equal (width, 34, EPSILON);
+  assert_float_equal (height, 44, EPSILON);
+
+  // the cache must notice different stroke parameters
+  sp.Thickness = 10;
+  uiDrawPathBounds (*state, &sp, &x, &y, &width, &height);
+  assert_float_equal (x, 5, EPSILON);
+  assert_float_equal (width, 40, EPSILON);
+}
+
+static void
+drawPathContainsPoint (void **state)
+{
+  uiDrawStrokeParams sp = { 0 };
+
+  assert_true (uiDrawPathContainsPoint (*state, NULL, 25, 40));
+  assert_false (uiDrawPathContainsPoint (*state, NULL, 5, 40));
+
+  sp.Cap        = uiDrawLineCapFlat;
+  sp.Join       = uiDrawLineJoinMiter;
+  sp.Thickness  = 4;
+  sp.MiterLimit = uiDrawDefaultMiterLimit;
+  assert_true (uiDrawPathContainsPoint (*state, &sp, 11, 40));
+  assert_false (uiDrawPathContainsPoint (*state, &sp, 25, 40));
+}
+
+static void
+drawPathLength (void **state)
+{
+  assert_float_equal (uiDrawPathLength (*state), 140, EPSILON);
+}
+
+static void
+drawPathFlatten (void **state)
+{
+  double       points[10 * 2];
+  int          newFigure[10];
+  const size_t n = uiDrawPathFlatten (*state, points, newFigure, 10);
+
+  // four corners and the closing copy of the first one
+  assert_int_equal (n, 5);
+  assert_true (newFigure[0]);
+  for (size_t i = 1; i < n; i++)
+    assert_false (newFigure[i]);
+  assert_float_equal (points[0], 10, EPSILON);
+  assert_float_equal (points[1], 20, EPSILON);
+  assert_float_equal (points[8], 10, EPSILON);
+  assert_float_equal (points[9], 20, EPSILON);
+
+  assert_int_equal (uiDrawPathFlatten (*state, NULL, NULL, 0), 5);
+}
+
+int
+drawPathRunUnitTests (void)
+{
+  const struct CMUnitTest tests[] = {
+    drawPathUnitTest (drawPathBounds),
+    drawPathUnitTest (drawPathContainsPoint),
+    drawPathUnitTest (drawPathLength),
+    drawPathUnitTest (drawPathFlatten),
+  };
+
+  return cmocka_run_group_tests_name ("uiDrawPath", tests, NULL, NULL);
+}
@@ -0,0 +1,213 @@
+#include "unit.h"
+
+#include <attrstr.h>
+
+#include <ui/draw.h>
+#include <ui/init.h>
+
+#include <threads.h>
+
+#define drawTextUnitTest(f) cmocka_unit_test_setup_teardown ((f), drawTextTestSetup, drawTextTestTeardown)
+
+#define EDITS 10000
+
+static int
+drawTextTestSetup (void **state)
+{
+  uiInitOptions o = { 0 };
+
+  assert_no_error (uiInit (&o));
+  *state = uiNewAttributedString ("Hello, world");
+  return 0;
+}
+
+static int
+drawTextTestTeardown (void **state)
+{
+  uiFreeAttributedString (*state);
+  uiUninit ();
+  return 0;
+}
+
+static uiDrawTextLayout *
+newLayout (uiAttributedString *s, const double width)
+{
+  uiFontDescriptor       f = { 0 };
+  uiDrawTextLayoutParams p = { 0 };
+
+  f.Family      = "Sans";
+  f.Size        = 12;
+  f.Weight      = uiTextWeightNormal;
+  f.Italic      = uiTextItalicNormal;
+  f.Stretch     = uiTextStretchNormal;
+  p.String      = s;
+  p.DefaultFont = &f;
+  p.Width       = width;
+  p.Align       = uiDrawTextAlignLeft;
+  return uiDrawNewTextLayout (&p);
+}
+
+static void
+drawTextLayoutCache (void **state)
+{
+  uiDrawTextLayoutCacheStats stats;
+  uiDrawTextLayout          *tl[4];
+
+  tl[0] = newLayout (*state, 100);
+  tl[1] = newLayout (*state, 100);
+  uiDrawTextLayoutCacheStatistics (&stats);
+  assert_int_equal (stats.Misses, 1);
+  assert_int_equal (stats.Hits, 1);
+  assert_int_equal (stats.Entries, 1);
+
+  // a different width is a different layout
+  tl[2] = newLayout (*state, 50);
+  uiDrawTextLayoutCacheStatistics (&stats);
+  assert_int_equal (stats.Misses, 2);
+
+  // so is a changed string
+  uiAttributedStringAppendUnattributed (*state, "!");
+  tl[3] = newLayout (*state, 100);
+  uiDrawTextLayoutCacheStatistics (&stats);
+  assert_int_equal (stats.Misses, 3);
+  assert_int_equal (stats.Hits, 1);
+
+  // freeing a shared layout leaves the others usable
+  for (int i = 0; i < 4; i++)
+    uiDrawFreeTextLayout (tl[i]);
+  tl[0] = newLayout (*state, 100);
+  uiDrawTextLayoutCacheStatistics (&stats);
+  assert_int_equal (stats.Hits, 2);
+  uiDrawFreeTextLayout (tl[0]);
+}
+
+static void
+drawTextLayoutLines (void **state)
+{
+  uiDrawTextLayoutLineMetrics m[2];
+  uiDrawTextLayout           *tl;
+
+  uiAttributedStringAppendUnattributed (*state, "\nsecond line");
+  tl = newLayout (*state, -1);
+  assert_int_equal (uiDrawTextLayoutNumLines (tl), 2);
+  uiDrawTextLayoutLineGetMetrics (tl, 0, &m[0]);
+  uiDrawTextLayoutLineGetMetrics (tl, 1, &m[1]);
+
+  // the line break belongs to the first line
+  assert_int_equal (m[0].Start, 0);
+  assert_int_equal (m[0].End, 13);
+  assert_int_equal (m[1].Start, 13);
+  assert_int_equal (m[1].End, 24);
+
+  assert_true (m[0].Height > 0);
+  assert_true (m[1].Y >= m[0].Y + m[0].Height);
+  assert_float_equal (m[0].Ascent + m[0].Descent, m[0].Height, 0.001);
+  assert_float_equal (m[0].Y + m[0].Ascent, m[0].BaselineY, 0.001);
+  uiDrawFreeTextLayout (tl);
+}
+
+static void
+drawTextLayoutHitTest (void **state)
+{
+  uiDrawTextLayout *tl = newLayout (*state, -1);
+  double            x, y, height;
+  size_t            pos;
+  int               line;
+
+  // every caret position maps back to itself
+  for (size_t i = 0; i <= 12; i++)
+    {
+      uiDrawTextLayoutCaret (tl, i, &x, &y, &height, &line);
+      assert_int_equal (line, 0);
+      assert_true (height > 0);
+      uiDrawTextLayoutHitTest (tl, x, y + height / 2, &pos, &line);
+      assert_int_equal (pos, i);
+      assert_int_equal (line, 0);
+    }
+
+  // points outside the text clamp to the nearest position
+  assert_false (uiDrawTextLayoutHitTest (tl, -100, 1, &pos, NULL));
+  assert_int_equal (pos, 0);
+  assert_false (uiDrawTextLayoutHitTest (tl, 10000, 1, &pos, NULL));
+  assert_int_equal (pos, 12);
+  uiDrawFreeTextLayout (tl);
+}
+
+static void
+drawTextLayoutRangeRects (void **state)
+{
+  uiDrawTextLayout *tl;
+  double            rects[4 * 4];
+  double            x, y, height;
+
+  uiAttributedStringAppendUnattributed (*state, "\nsecond line");
+  tl = newLayout (*state, -1);
+
+  // one rectangle on each line
+  assert_int_equal (uiDrawTextLayoutRangeRects (tl, 7, 20, NULL, 0), 2);
+  assert_int_equal (uiDrawTextLayoutRangeRects (tl, 7, 20, rects, 4), 2);
+  uiDrawTextLayoutCaret (tl, 7, &x, &y, &height, NULL);
+  assert_float_equal (rects[0], x, 0.001);
+  assert_true (rects[2] > 0);
+  assert_true (rects[5] > rects[1]);
+
+  assert_int_equal (uiDrawTextLayoutRangeRects (tl, 0, 5, rects, 4), 1);
+  uiDrawFreeTextLayout (tl);
+}
+
+static int
+editString (void *data)
+{
+  uint64_t           *revisions = data;
+  uiAttributedString *s         = uiNewAttributedString ("");
+
+  for (int i = 0; i < EDITS; i++)
+    {
+      uiAttributedStringAppendUnattributed (s, "x");
+      revisions[i] = uiprivAttributedStringRevision (s);
+    }
+  uiFreeAttributedString (s);
+  return 0;
+}
+
+static int
+compareRevisions (const void *a, const void *b)
+{
+  const uint64_t x = *(const uint64_t *)a;
+  const uint64_t y = *(const uint64_t *)b;
+
+  return (x > y) - (x < y);
+}
+
+static void
+drawTextRevisionsAcrossThreads (void **)
+{
+  uint64_t *revisions = calloc (2 * EDITS, sizeof (uint64_t));
+  thrd_t    threads[2];
+
+  // the layout cache is keyed on revisions, so strings edited by concurrent draw handlers must never share one
+  assert_non_null (revisions);
+  for (int i = 0; i < 2; i++)
+    assert_int_equal (thrd_create (&threads[i], editString, revisions + i * EDITS), thrd_success);
+  for (int i = 0; i < 2; i++)
+    thrd_join (threads[i], NULL);
+
+  qsort (revisions, 2 * EDITS, sizeof (uint64_t), compareRevisions);
+  for (int i = 1; i < 2 * EDITS; i++)
+    assert_true (revisions[i - 1] < revisions[i]);
+  free (revisions);
+}
+
+int
+drawTextRunUnitTests (void)
+{
+  const struct CMUnitTest tests[] = {
+    drawTextUnitTest (drawTextLayoutCache),
+    drawTextUnitTest (drawTextLayoutLines),
+    drawTextUnitTest (drawTextLayoutHitTest),
+    drawTextUnitTest (drawTextLayoutRangeRects),
+    drawTextUnitTest (drawTextRevisionsAcrossThreads),
+  };
+
+  return cmocka_run_group_tests_name ("uiDrawTextLayout", tests, NULL, NULL);
+}
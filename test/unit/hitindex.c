@@ -0,0 +1,200 @@
+#include "unit.h"
+
+#include <ui/draw.h>
+#include <ui/hit_index.h>
+#include <ui/init.h>
+
+#include <stdint.h>
+
+#define hitIndexUnitTest(f) cmocka_unit_test_setup_teardown ((f), hitIndexTestSetup, hitIndexTestTeardown)
+
+#define GRID_SIZE 100
+#define CELL_SIZE 10
+
+static int
+hitIndexTestSetup (void **state)
+{
+  uiInitOptions o = { 0 };
+
+  assert_no_error (uiInit (&o));
+  *state = uiNewHitIndex ();
+  return 0;
+}
+
+static int
+hitIndexTestTeardown (void **state)
+{
+  uiFreeHitIndex (*state);
+  uiUninit ();
+  return 0;
+}
+
+static void
+hitIndexEmpty (void **state)
+{
+  uintptr_t id = 0;
+
+  assert_int_equal (uiHitIndexHitTest (*state, 0, 0, &id), 0);
+  assert_int_equal (uiHitIndexQueryRectangle (*state, -100, -100, 200, 200, &id, 1), 0);
+}
+
+static void
+hitIndexGrid (void **state)
+{
+  uiHitIndex *idx = *state;
+  uintptr_t   id;
+
+  // small gaps between cells, so points between them miss
+  for (int y = 0; y < GRID_SIZE; y++)
+    for (int x = 0; x < GRID_SIZE; x++)
+      uiHitIndexAddRectangle (idx, (uintptr_t)(y * GRID_SIZE + x + 1), x * CELL_SIZE, y * CELL_SIZE, CELL_SIZE - 2,
+                              CELL_SIZE - 2);
+
+  for (int y = 0; y < GRID_SIZE; y++)
+    for (int x = 0; x < GRID_SIZE; x++)
+      {
+        assert_true (uiHitIndexHitTest (idx, x * CELL_SIZE + 4, y * CELL_SIZE + 4, &id));
+        assert_int_equal (id, y * GRID_SIZE + x + 1);
+        assert_false (uiHitIndexHitTest (idx, x * CELL_SIZE + 9, y * CELL_SIZE + 9, &id));
+      }
+  assert_false (uiHitIndexHitTest (idx, -1, -1, &id));
+  assert_false (uiHitIndexHitTest (idx, GRID_SIZE * CELL_SIZE + 1, 0, &id));
+}
+
+static void
+hitIndexTopmost (void **state)
+{
+  uiHitIndex *idx = *state;
+  uintptr_t   id;
+
+  uiHitIndexAddRectangle (idx, 1, 0, 0, 100, 100);
+  uiHitIndexAddRectangle (idx, 2, 50, 50, 100, 100);
+  uiHitIndexAddRectangle (idx, 3, 200, 200, 10, 10);
+
+  assert_true (uiHitIndexHitTest (idx, 25, 25, &id));
+  assert_int_equal (id, 1);
+  assert_true (uiHitIndexHitTest (idx, 75, 75, &id));
+  assert_int_equal (id, 2);
+
+  // adding after a query rebuilds the tree
+  uiHitIndexAddRectangle (idx, 4, 60, 60, 10, 10);
+  assert_true (uiHitIndexHitTest (idx, 65, 65, &id));
+  assert_int_equal (id, 4);
+}
+
+static void
+hitIndexQueryRectangle (void **state)
+{
+  uiHitIndex  *idx    = *state;
+  unsigned int seed   = 1;
+  double       r[2000][4];
+  uintptr_t    ids[2000];
+
+  for (size_t i = 0; i < 2000; i++)
+    {
+      for (int j = 0; j < 4; j++)
+        {
+          seed    = seed * 1103515245u + 12345u;
+          r[i][j] = (double)(seed >> 16 & 0x7FFF) / 0x7FFF * (j < 2 ? 1000 : 30);
+        }
+      uiHitIndexAddRectangle (idx, i, r[i][0], r[i][1], r[i][2], r[i][3]);
+    }
+
+  for (int q = 0; q < 50; q++)
+    {
+      const double x     = q * 20;
+      const double y     = 1000 - q * 20;
+      size_t       want  = 0;
+      size_t       found = uiHitIndexQueryRectangle (idx, x, y, 100, 50, ids, 2000);
+      int          seen[2000] = { 0 };
+
+      for (size_t i = 0; i < 2000; i++)
+        if (r[i][0] <= x + 100 && x <= r[i][0] + r[i][2] && r[i][1] <= y + 50 && y <= r[i][1] + r[i][3])
+          want++;
+      assert_int_equal (found, want);
+      for (size_t i = 0; i < found; i++)
+        {
+          assert_false (seen[ids[i]]);
+          seen[ids[i]] = 1;
+        }
+
+      // a short array gets filled, and the total is still reported
+      if (want > 1)
+        assert_int_equal (uiHitIndexQueryRectangle (idx, x, y, 100, 50, ids, 1), want);
+    }
+}
+
+static void
+hitIndexNegativeSize (void **state)
+{
+  uiHitIndex *idx = *state;
+  uintptr_t   id;
+  uintptr_t   ids[2];
+
+  uiHitIndexAddRectangle (idx, 1, 100, 100, -50, -50);
+  uiHitIndexAddRectangle (idx, 2, 200, 0, -20, 30);
+
+  assert_true (uiHitIndexHitTest (idx, 75, 75, &id));
+  assert_int_equal (id, 1);
+  assert_false (uiHitIndexHitTest (idx, 125, 125, &id));
+  assert_true (uiHitIndexHitTest (idx, 190, 15, &id));
+  assert_int_equal (id, 2);
+
+  assert_int_equal (uiHitIndexQueryRectangle (idx, 80, 80, -10, -10, ids, 2), 1);
+  assert_int_equal (ids[0], 1);
+}
+
+#ifdef uiBackendUnix
+static void
+hitIndexPath (void **state)
+{
+  uiHitIndex        *idx    = *state;
+  uiDrawPath        *circle = uiDrawNewPath (uiDrawFillModeWinding);
+  uiDrawPath        *line   = uiDrawNewPath (uiDrawFillModeWinding);
+  uiDrawStrokeParams sp     = { 0 };
+  uintptr_t          id;
+
+  uiDrawPathNewFigureWithArc (circle, 50, 50, 50, 0, 2 * uiPi, 0);
+  uiDrawPathCloseFigure (circle);
+  uiDrawPathEnd (circle);
+  uiDrawPathNewFigure (line, 200, 0);
+  uiDrawPathLineTo (line, 300, 100);
+  uiDrawPathEnd (line);
+
+  sp.Cap        = uiDrawLineCapFlat;
+  sp.Join       = uiDrawLineJoinMiter;
+  sp.Thickness  = 4;
+  sp.MiterLimit = uiDrawDefaultMiterLimit;
+  uiHitIndexAddPath (idx, 1, circle, NULL);
+  uiHitIndexAddPath (idx, 2, line, &sp);
+
+  assert_true (uiHitIndexHitTest (idx, 50, 50, &id));
+  assert_int_equal (id, 1);
+  // inside the bounding box, outside the circle
+  assert_false (uiHitIndexHitTest (idx, 5, 5, &id));
+
+  assert_true (uiHitIndexHitTest (idx, 251, 50, &id));
+  assert_int_equal (id, 2);
+  assert_false (uiHitIndexHitTest (idx, 260, 40, &id));
+
+  uiHitIndexClear (idx);
+  assert_false (uiHitIndexHitTest (idx, 50, 50, &id));
+
+  uiDrawFreePath (circle);
+  uiDrawFreePath (line);
+}
+#endif
+
+int
+hitIndexRunUnitTests (void)
+{
+  const struct CMUnitTest tests[] = {
+    hitIndexUnitTest (hitIndexEmpty),          hitIndexUnitTest (hitIndexGrid), hitIndexUnitTest (hitIndexTopmost),
+    hitIndexUnitTest (hitIndexQueryRectangle), hitIndexUnitTest (hitIndexNegativeSize),
+#ifdef uiBackendUnix
+    hitIndexUnitTest (hitIndexPath),
+#endif
+  };
+
+  return cmocka_run_group_tests_name ("uiHitIndex", tests, NULL, NULL);
+}
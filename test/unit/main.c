@@ -67,9 +67,13 @@ main (void)
   int                   failedTests      = 0;
   int                   failedComponents = 0;
   const struct unitTest unitTests[]      = {
-    { initRunUnitTests },         { menuRunUnitTests },   { sliderRunUnitTests },      { spinboxRunUnitTests },
-    { labelRunUnitTests },        { buttonRunUnitTests }, { comboboxRunUnitTests },    { checkboxRunUnitTests },
-    { radioButtonsRunUnitTests }, { entryRunUnitTests },  { progressBarRunUnitTests }, { drawMatrixRunUnitTests },
+    { initRunUnitTests },         { menuRunUnitTests },     { sliderRunUnitTests },      { spinboxRunUnitTests },
+    { labelRunUnitTests },        { buttonRunUnitTests },   { comboboxRunUnitTests },    { checkboxRunUnitTests },
+    { radioButtonsRunUnitTests }, { entryRunUnitTests },    { progressBarRunUnitTests }, { drawMatrixRunUnitTests },
+    { pixelsRunUnitTests },       { hitIndexRunUnitTests },
+#ifdef uiBackendUnix
+    { drawPathRunUnitTests }, { drawTextRunUnitTests }, { mainLoopRunUnitTests }, { asyncRunUnitTests },
+#endif
   };
 
   for (size_t i = 0; i < sizeof (unitTests) / sizeof (*unitTests); ++i)
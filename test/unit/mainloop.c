@@ -0,0 +1,475 @@
+#include "unit.h"
+
+#include <ui/init.h>
+#include <ui/main.h>
+
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+#define mainLoopUnitTest(f) cmocka_unit_test_setup_teardown ((f), mainLoopTestSetup, mainLoopTestTeardown)
+
+#define MS 1000000
+
+static int
+mainLoopTestSetup (void **)
+{
+  uiInitOptions o = { 0 };
+
+  assert_no_error (uiInit (&o));
+  uiMainSteps ();
+  return 0;
+}
+
+static int
+mainLoopTestTeardown (void **)
+{
+  uiUninit ();
+  return 0;
+}
+
+static void
+count (void *data)
+{
+  int *n = data;
+
+  (*n)++;
+}
+
+static void
+block (void *)
+{
+  const struct timespec ts = { 0, 30 * MS };
+
+  nanosleep (&ts, NULL);
+}
+
+static void
+runQueued (void)
+{
+  uiMainStepResult r;
+
+  // drain whatever is ready, queued calls included
+  do
+    uiMainStepFor (uiMainTime () + 100 * MS, &r);
+  while (r.Pending);
+}
+
+static void
+runUntil (const int *done, int64_t timeout)
+{
+  const int64_t         end = uiMainTime () + timeout;
+  const struct timespec ts  = { 0, MS / 4 };
+
+  // uiMainStepFor() doesn't wait; sleep a little in between instead
+  while (!*done && uiMainTime () < end)
+    {
+      runQueued ();
+      nanosleep (&ts, NULL);
+    }
+}
+
+static void
+runFor (int64_t duration)
+{
+  const int never = 0;
+
+  runUntil (&never, duration);
+}
+
+static void
+mainLoopQueueStatistics (void **)
+{
+  uiMainSourceStats s;
+  int               n = 0;
+
+  uiMainSetInstrumentation (1, 0);
+  for (int i = 0; i < 10; i++)
+    uiQueueMain (count, &n);
+  runQueued ();
+  assert_int_equal (n, 10);
+
+  uiMainSourceStatistics (uiMainSourceQueue, &s);
+  assert_int_equal (s.Dispatches, 10);
+  assert_true (s.MaxTime <= s.Time);
+  assert_true (s.MaxLatency <= s.Latency);
+
+  // turning it on again starts over
+  uiMainSetInstrumentation (1, 0);
+  uiMainSourceStatistics (uiMainSourceQueue, &s);
+  assert_int_equal (s.Dispatches, 0);
+}
+
+static void
+onStall (const uiMainStall *stall, void *data)
+{
+  uiMainStall *last = data;
+
+  *last = *stall;
+}
+
+static void
+mainLoopStalls (void **)
+{
+  uiMainStall last = { 0 };
+  uiMainStall stalls[4];
+  size_t      n;
+
+  uiMainSetInstrumentation (1, 10 * MS);
+  uiMainOnStall (onStall, &last);
+  uiQueueMain (block, NULL);
+  runQueued ();
+  // the stall is noticed when the loop polls again
+  runQueued ();
+
+  n = uiMainStalls (stalls, 4);
+  assert_true (n >= 1);
+  assert_true (stalls[0].Duration >= 30 * MS);
+  assert_int_equal (stalls[0].Culprit, uiMainSourceQueue);
+  assert_int_equal (last.Culprit, uiMainSourceQueue);
+  uiMainOnStall (NULL, NULL);
+}
+
+struct idleLog
+{
+  int order[8];
+  int n;
+};
+
+static struct idleLog idleLog;
+
+static int
+logIdle (void *data)
+{
+  idleLog.order[idleLog.n++] = (int)(intptr_t)data;
+  return 0;
+}
+
+static int
+chunks (void *data)
+{
+  int *left = data;
+
+  return --(*left) > 0;
+}
+
+static void
+mainLoopIdle (void **)
+{
+  int left = 4;
+
+  idleLog.n = 0;
+  uiQueueIdle (uiIdlePriorityLow, logIdle, (void *)3);
+  uiQueueIdle (uiIdlePriorityNormal, logIdle, (void *)2);
+  uiQueueIdle (uiIdlePriorityHigh, logIdle, (void *)1);
+  uiQueueIdle (uiIdlePriorityNormal, chunks, &left);
+  runQueued ();
+
+  assert_int_equal (idleLog.n, 3);
+  assert_int_equal (idleLog.order[0], 1);
+  assert_int_equal (idleLog.order[1], 2);
+  assert_int_equal (idleLog.order[2], 3);
+  // called until it said it was done
+  assert_int_equal (left, 0);
+}
+
+struct coalescedLog
+{
+  int runs;
+  int last;
+  int discards;
+  int discarded[8];
+};
+
+static struct coalescedLog coalescedLog;
+
+static void
+logCoalesced (void *data)
+{
+  coalescedLog.runs++;
+  coalescedLog.last = (int)(intptr_t)data;
+}
+
+static void
+discardCoalesced (void *data)
+{
+  coalescedLog.discarded[coalescedLog.discards++] = (int)(intptr_t)data;
+}
+
+static void
+mainLoopCoalesced (void **)
+{
+  int key;
+
+  coalescedLog = (struct coalescedLog){ 0 };
+  for (int i = 1; i <= 5; i++)
+    uiQueueMainCoalesced (&key, logCoalesced, (void *)(intptr_t)i, discardCoalesced);
+  // a replaced value is discarded right away
+  assert_int_equal (coalescedLog.discards, 4);
+  for (int i = 0; i < 4; i++)
+    assert_int_equal (coalescedLog.discarded[i], i + 1);
+  runQueued ();
+  assert_int_equal (coalescedLog.runs, 1);
+  assert_int_equal (coalescedLog.last, 5);
+
+  // once it ran, the key queues a new call
+  uiQueueMainCoalesced (&key, logCoalesced, (void *)6, discardCoalesced);
+  runQueued ();
+  assert_int_equal (coalescedLog.runs, 2);
+  assert_int_equal (coalescedLog.last, 6);
+  assert_int_equal (coalescedLog.discards, 4);
+}
+
+static void
+mainLoopCoalescedUninit (void **)
+{
+  int key;
+
+  coalescedLog = (struct coalescedLog){ 0 };
+  uiQueueMainCoalesced (&key, logCoalesced, (void *)1, discardCoalesced);
+  uiQueueMainCoalesced (&key, logCoalesced, (void *)2, discardCoalesced);
+  // the value that never ran is discarded too
+  uiUninit ();
+  assert_int_equal (coalescedLog.runs, 0);
+  assert_int_equal (coalescedLog.discards, 2);
+  assert_int_equal (coalescedLog.discarded[0], 1);
+  assert_int_equal (coalescedLog.discarded[1], 2);
+}
+
+struct timerLog
+{
+  int64_t        fired[4];
+  int            n;
+  uiTimerHandle *self;
+  uiTimerHandle *other;
+};
+
+static int
+logTimer (void *data)
+{
+  struct timerLog *l = data;
+
+  l->fired[l->n++] = uiMainTime ();
+  return 0;
+}
+
+static void
+mainLoopTimerNotEarly (void **)
+{
+  // started at all sorts of points within a millisecond
+  for (int i = 0; i < 50; i++)
+    {
+      struct timerLog l       = { 0 };
+      const int64_t   started = uiMainTime ();
+
+      uiNewTimer (2, logTimer, &l);
+      runUntil (&l.n, 100 * MS);
+      assert_int_equal (l.n, 1);
+      assert_true (l.fired[0] - started >= 2 * MS);
+    }
+}
+
+static void
+mainLoopTimerCascade (void **)
+{
+  struct timerLog l[3]    = { 0 };
+  const int64_t   started = uiMainTime ();
+
+  // the first level of the wheel covers 256 ms; the other two are cascaded down into it before they fire
+  uiNewTimer (100, logTimer, &l[0]);
+  uiNewTimer (300, logTimer, &l[1]);
+  uiNewTimer (600, logTimer, &l[2]);
+  runUntil (&l[2].n, 2000 * MS);
+  for (int i = 0; i < 3; i++)
+    assert_int_equal (l[i].n, 1);
+  assert_true (l[0].fired[0] - started >= 100 * MS);
+  assert_true (l[1].fired[0] - started >= 300 * MS);
+  assert_true (l[2].fired[0] - started >= 600 * MS);
+  assert_true (l[0].fired[0] <= l[1].fired[0]);
+  assert_true (l[1].fired[0] <= l[2].fired[0]);
+}
+
+static int
+cancelTimers (void *data)
+{
+  struct timerLog *l = data;
+
+  l->fired[l->n++] = uiMainTime ();
+  uiTimerCancel (l->other);
+  uiTimerCancel (l->self);
+  // canceled wins over asking to run again
+  return 1;
+}
+
+static void
+mainLoopTimerCancelInCallback (void **)
+{
+  struct timerLog l     = { 0 };
+  struct timerLog other = { 0 };
+
+  l.self  = uiNewTimer (5, cancelTimers, &l);
+  l.other = uiNewTimer (10, logTimer, &other);
+  runUntil (&l.n, 100 * MS);
+  assert_int_equal (l.n, 1);
+  runFor (30 * MS);
+  assert_int_equal (l.n, 1);
+  assert_int_equal (other.n, 0);
+}
+
+struct fdLog
+{
+  int n;
+  int events;
+};
+
+static int
+readOne (uiFDWatch *, int fd, int events, void *data)
+{
+  struct fdLog *l = data;
+  char          c;
+
+  l->n++;
+  l->events = events;
+  assert_int_equal (read (fd, &c, 1), 1);
+  return 1;
+}
+
+static int
+logFD (uiFDWatch *, int, int events, void *data)
+{
+  struct fdLog *l = data;
+
+  l->n++;
+  l->events = events;
+  return 1;
+}
+
+static int
+unwatchSelf (uiFDWatch *w, int, int events, void *data)
+{
+  struct fdLog *l = data;
+
+  l->n++;
+  l->events = events;
+  uiMainUnwatchFD (w);
+  // removed wins over asking to keep watching
+  return 1;
+}
+
+static int
+logOnce (uiFDWatch *, int, int events, void *data)
+{
+  struct fdLog *l = data;
+
+  l->n++;
+  l->events = events;
+  return 0;
+}
+
+static void
+mainLoopWatchFDLevel (void **)
+{
+  struct fdLog l = { 0 };
+  uiFDWatch   *w;
+  int          fds[2];
+
+  assert_int_equal (pipe (fds), 0);
+  assert_int_equal (write (fds[1], "ab", 2), 2);
+  w = uiMainWatchFD (fds[0], uiWatchFDRead, readOne, &l);
+  // called again as long as there's something left to read
+  runFor (30 * MS);
+  assert_int_equal (l.n, 2);
+  assert_int_equal (l.events, uiWatchFDRead);
+
+  assert_int_equal (write (fds[1], "c", 1), 1);
+  runFor (30 * MS);
+  assert_int_equal (l.n, 3);
+
+  uiMainUnwatchFD (w);
+  close (fds[0]);
+  close (fds[1]);
+}
+
+static void
+mainLoopWatchFDEdge (void **)
+{
+  struct fdLog l = { 0 };
+  uiFDWatch   *w;
+  int          fds[2];
+
+  assert_int_equal (pipe (fds), 0);
+  assert_int_equal (write (fds[1], "ab", 2), 2);
+  w = uiMainWatchFD (fds[0], uiWatchFDRead | uiWatchFDEdge, logFD, &l);
+  // nothing was read, but it's only reported once
+  runFor (30 * MS);
+  assert_int_equal (l.n, 1);
+  assert_int_equal (l.events, uiWatchFDRead);
+
+  uiMainWatchFDRearm (w);
+  runFor (30 * MS);
+  assert_int_equal (l.n, 2);
+
+  uiMainUnwatchFD (w);
+  close (fds[0]);
+  close (fds[1]);
+}
+
+static void
+mainLoopWatchFDUnwatchInCallback (void **)
+{
+  struct fdLog l = { 0 };
+  int          fds[2];
+
+  assert_int_equal (pipe (fds), 0);
+  assert_int_equal (write (fds[1], "ab", 2), 2);
+  uiMainWatchFD (fds[0], uiWatchFDRead, unwatchSelf, &l);
+  runFor (30 * MS);
+  assert_int_equal (l.n, 1);
+
+  close (fds[0]);
+  close (fds[1]);
+}
+
+static void
+mainLoopWatchFDHangup (void **)
+{
+  struct fdLog l = { 0 };
+  int          fds[2];
+
+  assert_int_equal (pipe (fds), 0);
+  uiMainWatchFD (fds[0], uiWatchFDRead, logOnce, &l);
+  runFor (10 * MS);
+  assert_int_equal (l.n, 0);
+
+  close (fds[1]);
+  runUntil (&l.n, 100 * MS);
+  assert_int_equal (l.n, 1);
+  assert_true ((l.events & uiWatchFDHangup) != 0);
+  // returning zero removed the watch
+  runFor (10 * MS);
+  assert_int_equal (l.n, 1);
+
+  close (fds[0]);
+}
+
+int
+mainLoopRunUnitTests (void)
+{
+  const struct CMUnitTest tests[] = {
+    mainLoopUnitTest (mainLoopQueueStatistics),
+    mainLoopUnitTest (mainLoopStalls),
+    mainLoopUnitTest (mainLoopIdle),
+    mainLoopUnitTest (mainLoopCoalesced),
+    mainLoopUnitTest (mainLoopTimerNotEarly),
+    mainLoopUnitTest (mainLoopTimerCascade),
+    mainLoopUnitTest (mainLoopTimerCancelInCallback),
+    mainLoopUnitTest (mainLoopWatchFDLevel),
+    mainLoopUnitTest (mainLoopWatchFDEdge),
+    mainLoopUnitTest (mainLoopWatchFDUnwatchInCallback),
+    mainLoopUnitTest (mainLoopWatchFDHangup),
+    // uninitializes by itself
+    cmocka_unit_test_setup_teardown (mainLoopCoalescedUninit, mainLoopTestSetup, NULL),
+  };
+
+  return cmocka_run_group_tests_name ("uiMain", tests, NULL, NULL);
+}
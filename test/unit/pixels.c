@@ -0,0 +1,113 @@
+#include "unit.h"
+
+#include <uipriv.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#define pixelsUnitTest(f) cmocka_unit_test (f)
+
+/**
+ * @brief Straightforward reference for uiprivRGBAToARGB32() that the vectorized paths must match byte for byte.
+ */
+static void
+referenceRGBAToARGB32 (uint8_t *dst, const size_t dstStride, const uint8_t *src, const size_t srcStride,
+                       const int width, const int height, const int premultiply)
+{
+  for (int y = 0; y < height; y++)
+    for (int x = 0; x < width; x++)
+      {
+        const uint8_t *p = src + y * srcStride + x * 4;
+        uint32_t       r = p[0];
+        uint32_t       g = p[1];
+        uint32_t       b = p[2];
+        const uint32_t a = p[3];
+        uint32_t       v;
+
+        if (premultiply)
+          {
+            r = (r * a + 127) / 255;
+            g = (g * a + 127) / 255;
+            b = (b * a + 127) / 255;
+          }
+        v = a << 24 | r << 16 | g << 8 | b;
+        memcpy (dst + y * dstStride + x * 4, &v, sizeof (v));
+      }
+}
+
+static void
+checkAgainstReference (const int width, const int height, const int premultiply)
+{
+  // odd strides exercise the row stepping; widths up to 70 cover every vector body and tail length
+  const size_t srcStride = width * 4 + 3;
+  const size_t dstStride = width * 4 + 8;
+  uint8_t     *src       = malloc (srcStride * height + 1);
+  uint8_t     *got       = malloc (dstStride * height + 1);
+  uint8_t     *want      = malloc (dstStride * height + 1);
+
+  assert_non_null (src);
+  assert_non_null (got);
+  assert_non_null (want);
+
+  for (size_t i = 0; i < srcStride * height; i++)
+    src[i] = (uint8_t)(rand () & 0xFF);
+  memset (got, 0xAB, dstStride * height);
+  memset (want, 0xAB, dstStride * height);
+
+  uiprivRGBAToARGB32 (got, dstStride, src, srcStride, width, height, premultiply);
+  referenceRGBAToARGB32 (want, dstStride, src, srcStride, width, height, premultiply);
+  assert_memory_equal (got, want, dstStride * height);
+
+  free (src);
+  free (got);
+  free (want);
+}
+
+static void
+pixelsConvert (void **)
+{
+  for (int width = 0; width <= 70; width++)
+    checkAgainstReference (width, 3, 0);
+}
+
+static void
+pixelsConvertPremultiply (void **)
+{
+  for (int width = 0; width <= 70; width++)
+    checkAgainstReference (width, 3, 1);
+}
+
+static void
+pixelsPremultiplyExtremes (void **)
+{
+  // every color and alpha combination, 256 pixels per row
+  uint8_t src[256 * 4];
+  uint8_t got[256 * 4];
+  uint8_t want[256 * 4];
+
+  for (int a = 0; a < 256; a++)
+    {
+      for (int c = 0; c < 256; c++)
+        {
+          src[c * 4]     = (uint8_t)c;
+          src[c * 4 + 1] = (uint8_t)(255 - c);
+          src[c * 4 + 2] = (uint8_t)c;
+          src[c * 4 + 3] = (uint8_t)a;
+        }
+      uiprivRGBAToARGB32 (got, sizeof (got), src, sizeof (src), 256, 1, 1);
+      referenceRGBAToARGB32 (want, sizeof (want), src, sizeof (src), 256, 1, 1);
+      assert_memory_equal (got, want, sizeof (got));
+    }
+}
+
+int
+pixelsRunUnitTests (void)
+{
+  const struct CMUnitTest tests[] = {
+    pixelsUnitTest (pixelsConvert),
+    pixelsUnitTest (pixelsConvertPremultiply),
+    pixelsUnitTest (pixelsPremultiplyExtremes),
+  };
+
+  return cmocka_run_group_tests_name ("uiprivRGBAToARGB32", tests, NULL, NULL);
+}
@@ -36,6 +36,18 @@ int entryRunUnitTests (void);
 int menuRunUnitTests (void);
 int progressBarRunUnitTests (void);
 int drawMatrixRunUnitTests (void);
+int pixelsRunUnitTests (void);
+int hitIndexRunUnitTests (void);
+
+#ifdef uiBackendUnix
+/**
+ * Unit test run functions for APIs only the GTK backend has so far.
+ */
+int drawPathRunUnitTests (void);
+int drawTextRunUnitTests (void);
+int mainLoopRunUnitTests (void);
+int asyncRunUnitTests (void);
+#endif
 
 /**
  * Helper for general setup/teardown of controls embedded in a window.